@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    BandMeters.cpp
+
+  ==============================================================================
+*/
+
+#include "BandMeters.h"
+
+//==============================================================================
+template <int NumBands>
+template <typename SampleType>
+void BandMeters<NumBands>::Accumulator::add(const juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    auto n = buffer.getNumSamples();
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        auto* data = buffer.getReadPointer(channel);
+
+        auto range = juce::FloatVectorOperations::findMinAndMax(data, n);
+        peak = juce::jmax(peak, (float)-range.getStart(), (float)range.getEnd());
+
+        // Independent partial sums, so the loop isn't one long dependency chain
+        SampleType sums[4] = {};
+        int i = 0;
+
+        for (; i + 4 <= n; i += 4)
+            for (int k = 0; k < 4; ++k)
+                sums[k] += data[i + k] * data[i + k];
+
+        for (; i < n; ++i)
+            sums[0] += data[i] * data[i];
+
+        sumOfSquares += (double)(sums[0] + sums[1] + sums[2] + sums[3]);
+    }
+
+    numSamples += n * buffer.getNumChannels();
+}
+
+template <int NumBands>
+typename BandMeters<NumBands>::Level BandMeters<NumBands>::Accumulator::getLevel() const noexcept
+{
+    Level level;
+    level.peak = peak;
+    level.rms = numSamples > 0 ? (float)std::sqrt(sumOfSquares / numSamples) : 0.0f;
+    return level;
+}
+
+//==============================================================================
+template <int NumBands>
+template <typename SampleType>
+void BandMeters<NumBands>::measureBand(int band, const juce::AudioBuffer<SampleType>& dry, const juce::AudioBuffer<SampleType>& wet) noexcept
+{
+    dryAccumulators[(size_t)band].add(dry);
+    wetAccumulators[(size_t)band].add(wet);
+}
+
+template <int NumBands>
+void BandMeters<NumBands>::push(float feedbackGain) noexcept
+{
+    const auto scope = fifo.write(1);
+
+    if (scope.blockSize1 > 0)
+    {
+        auto& frame = frames[(size_t)scope.startIndex1];
+        frame.feedback = {};
+
+        for (size_t band = 0; band < (size_t)NumBands; ++band)
+        {
+            frame.dry[band] = dryAccumulators[band].getLevel();
+            frame.wet[band] = wetAccumulators[band].getLevel();
+
+            // Whatever leaves a band's delay is written back into its line
+            frame.feedback.peak = juce::jmax(frame.feedback.peak, feedbackGain * frame.wet[band].peak);
+            frame.feedback.rms = juce::jmax(frame.feedback.rms, feedbackGain * frame.wet[band].rms);
+        }
+    }
+
+    for (auto* accumulators : { &dryAccumulators, &wetAccumulators })
+        accumulators->fill({});
+}
+
+template <int NumBands>
+bool BandMeters<NumBands>::pop(Frame& frame) noexcept
+{
+    const auto scope = fifo.read(1);
+
+    if (scope.blockSize1 == 0)
+        return false;
+
+    frame = frames[(size_t)scope.startIndex1];
+    return true;
+}
+
+//==============================================================================
+#define BSD_INSTANTIATE_METERS(numBands) \
+    template class BandMeters<numBands>; \
+    template void BandMeters<numBands>::measureBand(int, const juce::AudioBuffer<float>&, const juce::AudioBuffer<float>&) noexcept; \
+    template void BandMeters<numBands>::measureBand(int, const juce::AudioBuffer<double>&, const juce::AudioBuffer<double>&) noexcept;
+
+BSD_INSTANTIATE_METERS(2)
+BSD_INSTANTIATE_METERS(3)
+BSD_INSTANTIATE_METERS(4)
+BSD_INSTANTIATE_METERS(5)
+BSD_INSTANTIATE_METERS(6)
+BSD_INSTANTIATE_METERS(7)
+BSD_INSTANTIATE_METERS(8)
+
+#undef BSD_INSTANTIATE_METERS
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    BandMeters.h
+
+    Peak and RMS of every band's dry and wet signal, and the level fed back
+    into the delays, handed from the audio thread to the editor.
+
+    Each band job measures its own band, the audio thread pushes one frame
+    per processBlock into a juce::AbstractFifo of preallocated frames, and
+    the editor pops them on its timer. Both sides only touch the FIFO's
+    atomic positions, so neither waits, locks or allocates. Frames are
+    dropped when the editor falls behind.
+
+    Measuring is skipped entirely while no editor is open, which leaves the
+    audio thread one atomic load per block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+template <int NumBands>
+class BandMeters
+{
+public:
+    static constexpr int numBands = NumBands;
+
+    struct Level
+    {
+        float peak{ 0.0f };
+        float rms{ 0.0f };
+    };
+
+    // Levels are taken before the band's dry and wet gains, so a band can
+    // be watched while it's muted
+    struct Frame
+    {
+        std::array<Level, NumBands> dry, wet;
+        Level feedback;
+    };
+
+    // Editor side
+    void setActive(bool shouldBeActive) noexcept { active.store(shouldBeActive, std::memory_order_relaxed); }
+    bool isActive() const noexcept { return active.load(std::memory_order_relaxed); }
+
+    // Returns false when there's nothing new
+    bool pop(Frame& frame) noexcept;
+
+    // Audio side. measureBand() may run on any thread, once per band and
+    // sub-block; push() publishes everything measured since the last push.
+    template <typename SampleType>
+    void measureBand(int band, const juce::AudioBuffer<SampleType>& dry, const juce::AudioBuffer<SampleType>& wet) noexcept;
+    void push(float feedbackGain) noexcept;
+
+private:
+    struct Accumulator
+    {
+        float peak{ 0.0f };
+        double sumOfSquares{ 0.0 };
+        int numSamples{ 0 };
+
+        template <typename SampleType>
+        void add(const juce::AudioBuffer<SampleType>& buffer) noexcept;
+        Level getLevel() const noexcept;
+    };
+
+    static constexpr int capacity = 32;
+
+    std::array<Accumulator, NumBands> dryAccumulators, wetAccumulators;
+
+    juce::AbstractFifo fifo{ capacity };
+    std::array<Frame, capacity> frames;
+
+    std::atomic<bool> active{ false };
+};
@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    BandMixer.cpp
+
+  ==============================================================================
+*/
+
+#include "BandMixer.h"
+
+template <int NumBands>
+void BandMixer<NumBands>::reset()
+{
+    snapToTargets = true;
+}
+
+template <int NumBands>
+void BandMixer<NumBands>::setBandGains(int band, float dryGain, float wetGain)
+{
+    jassert(juce::isPositiveAndBelow(band, numBands));
+
+    gains[(size_t)(band * 2)].target = dryGain;
+    gains[(size_t)(band * 2 + 1)].target = wetGain;
+}
+
+template <int NumBands>
+template <typename SampleType>
+void BandMixer<NumBands>::process(juce::AudioBuffer<SampleType>& output, const BandBuffers<SampleType>& dry,
+                                  const BandBuffers<SampleType>& wet, BandBuffers<SampleType>* bandMixes)
+{
+    auto numSamples = output.getNumSamples();
+
+    if (snapToTargets)
+    {
+        for (auto& gain : gains)
+            gain.current = gain.target;
+
+        snapToTargets = false;
+    }
+
+    // Gain at sample i is start + increment * i, as in AudioBuffer::applyGainRamp
+    struct Source
+    {
+        const juce::AudioBuffer<SampleType>* buffer;
+        int band;
+        SampleType start, increment;
+    };
+
+    std::array<Source, numSources> sources;
+    auto numActive = 0;
+
+    for (int i = 0; i < numSources; ++i)
+    {
+        auto& gain = gains[(size_t)i];
+
+        if (gain.current != 0.0f || gain.target != 0.0f)
+        {
+            auto& buffer = (i % 2 == 0) ? dry[(size_t)(i / 2)] : wet[(size_t)(i / 2)];
+            sources[(size_t)numActive++] = { &buffer, i / 2, (SampleType)gain.current,
+                                             (SampleType)(gain.target - gain.current) / (SampleType)numSamples };
+        }
+
+        gain.current = gain.target;
+    }
+
+    if (numActive == 0)
+    {
+        output.clear();
+
+        if (bandMixes != nullptr)
+            for (auto& mix : *bandMixes)
+                mix.clear(0, numSamples);
+
+        return;
+    }
+
+    for (int channel = 0; channel < output.getNumChannels(); ++channel)
+    {
+        auto* out = output.getWritePointer(channel);
+
+        // Sum each chunk in a local accumulator, so every source is read
+        // once and the output written once
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            auto count = juce::jmin(chunkSize, numSamples - start);
+            SampleType accumulator[chunkSize] = {};
+            auto k = 0;
+
+            for (int band = 0; band < numBands; ++band)
+            {
+                // Sources are in band order. Without bandMixes every band
+                // sums straight into the accumulator.
+                SampleType bandAccumulator[chunkSize];
+                auto* sum = accumulator;
+
+                if (bandMixes != nullptr)
+                {
+                    juce::FloatVectorOperations::clear(bandAccumulator, count);
+                    sum = bandAccumulator;
+                }
+
+                for (; k < numActive && sources[(size_t)k].band == band; ++k)
+                {
+                    auto& source = sources[(size_t)k];
+
+                    if (channel >= source.buffer->getNumChannels())
+                        continue;
+
+                    auto* in = source.buffer->getReadPointer(channel, start);
+                    auto gain = source.start + source.increment * (SampleType)start;
+                    auto increment = source.increment;
+
+                    for (int i = 0; i < count; ++i)
+                        sum[i] += in[i] * (gain + increment * (SampleType)i);
+                }
+
+                if (bandMixes != nullptr)
+                {
+                    auto& mix = (*bandMixes)[(size_t)band];
+
+                    if (channel < mix.getNumChannels())
+                        juce::FloatVectorOperations::copy(mix.getWritePointer(channel, start), bandAccumulator, count);
+
+                    juce::FloatVectorOperations::add(accumulator, bandAccumulator, count);
+                }
+            }
+
+            juce::FloatVectorOperations::copy(out + start, accumulator, count);
+        }
+    }
+}
+
+//==============================================================================
+#define BSD_INSTANTIATE_MIXER(numBands) \
+    template class BandMixer<numBands>; \
+    template void BandMixer<numBands>::process(juce::AudioBuffer<float>&, const BandBuffers<float>&, \
+                                               const BandBuffers<float>&, BandBuffers<float>*); \
+    template void BandMixer<numBands>::process(juce::AudioBuffer<double>&, const BandBuffers<double>&, \
+                                               const BandBuffers<double>&, BandBuffers<double>*);
+
+BSD_INSTANTIATE_MIXER(2)
+BSD_INSTANTIATE_MIXER(3)
+BSD_INSTANTIATE_MIXER(4)
+BSD_INSTANTIATE_MIXER(5)
+BSD_INSTANTIATE_MIXER(6)
+BSD_INSTANTIATE_MIXER(7)
+BSD_INSTANTIATE_MIXER(8)
+
+#undef BSD_INSTANTIATE_MIXER
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    BandMixer.h
+
+    Applies the dry and wet gain of every band and sums them into the
+    output in one pass. Gains ramp linearly from the previous block's values,
+    and sources whose gain stays at zero for the whole block are skipped.
+
+    process() takes float or double buffers and sums in that precision.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+template <int NumBands>
+class BandMixer
+{
+public:
+    static constexpr int numBands = NumBands;
+
+    template <typename SampleType>
+    using BandBuffers = std::array<juce::AudioBuffer<SampleType>, numBands>;
+
+    // The next block starts at the target gains instead of ramping to them
+    void reset();
+
+    void setBandGains(int band, float dryGain, float wetGain);
+
+    // Overwrites output with the sum of all bands, dry and wet. If bandMixes
+    // is given, each band's own dry + wet mix is also written there in the
+    // same pass; it may be the wet buffers.
+    template <typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& output, const BandBuffers<SampleType>& dry, const BandBuffers<SampleType>& wet,
+                 BandBuffers<SampleType>* bandMixes = nullptr);
+
+private:
+    struct RampedGain
+    {
+        float current{ 0.0f };
+        float target{ 0.0f };
+    };
+
+    static constexpr int numSources = numBands * 2;
+    static constexpr int chunkSize = 64;
+
+    std::array<RampedGain, numSources> gains;
+    bool snapToTargets{ true };
+};
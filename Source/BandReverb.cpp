@@ -0,0 +1,254 @@
+/*
+  ==============================================================================
+
+    BandReverb.cpp
+
+  ==============================================================================
+*/
+
+#include "BandReverb.h"
+
+namespace {
+
+    // Line lengths at 44.1 kHz, taken from the Freeverb comb filters so the
+    // echoes don't line up. The right channel is offset by the same spread.
+    constexpr std::array<int, 4> baseLineLengths{ 1116, 1277, 1491, 1617 };
+    constexpr int stereoSpread = 23;
+}
+
+//==============================================================================
+template <int NumBands>
+void BandReverb<NumBands>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    jassert(spec.sampleRate > 0);
+    jassert(spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    channels.resize(spec.numChannels);
+
+    auto scale = sampleRate / 44100.0;
+    size_t totalSamples = 0;
+
+    for (size_t channel = 0; channel < channels.size(); ++channel)
+    {
+        for (size_t line = 0; line < (size_t)numLines; ++line)
+        {
+            auto length = baseLineLengths[line] + (channel % 2 == 1 ? stereoSpread : 0);
+            channels[channel].lines[line].length = juce::jmax(1, juce::roundToInt(length * scale));
+            totalSamples += (size_t)channels[channel].lines[line].length;
+        }
+    }
+
+    storageSize = totalSamples * (size_t)numSlots;
+    storage.allocate(storageSize + (size_t)numLanes, true);
+    scratchMemory.allocate(channels.size() * (size_t)(chunkSize * numSlots) + (size_t)numLanes, true);
+
+   #if JUCE_USE_SIMD
+    auto* data = Lanes::getNextSIMDAlignedPtr(storage.get());
+    auto* scratch = Lanes::getNextSIMDAlignedPtr(scratchMemory.get());
+   #else
+    auto* data = storage.get();
+    auto* scratch = scratchMemory.get();
+   #endif
+
+    for (auto& state : channels)
+    {
+        for (auto& line : state.lines)
+        {
+            line.data = data;
+            data += (size_t)line.length * (size_t)numSlots;
+        }
+
+        state.scratch = scratch;
+        scratch += chunkSize * numSlots;
+    }
+
+    updateFeedbackGains();
+    reset();
+}
+
+template <int NumBands>
+void BandReverb<NumBands>::reset()
+{
+    if (storage != nullptr)
+        juce::FloatVectorOperations::clear(storage.get(), (int)(storageSize + (size_t)numLanes));
+
+    for (auto& state : channels)
+    {
+        for (auto& line : state.lines)
+        {
+            line.position = 0;
+            line.lowpass.fill(Lanes::expand(0.0f));
+        }
+    }
+}
+
+template <int NumBands>
+void BandReverb<NumBands>::setBandSize(int band, float size)
+{
+    jassert(juce::isPositiveAndBelow(band, numBands));
+
+    size = juce::jlimit(0.0f, 1.0f, size);
+
+    if (size != sizes[(size_t)band])
+    {
+        sizes[(size_t)band] = size;
+        decayTimes[(size_t)band] = minDecaySeconds * std::pow(maxDecaySeconds / minDecaySeconds, size);
+        updateFeedbackGains();
+    }
+}
+
+template <int NumBands>
+float BandReverb<NumBands>::getDecayTime() const noexcept
+{
+    return *std::max_element(decayTimes.begin(), decayTimes.end());
+}
+
+template <int NumBands>
+size_t BandReverb<NumBands>::getMemoryFootprint() const noexcept
+{
+    return (storageSize + channels.size() * (size_t)(chunkSize * numSlots) + (size_t)(2 * numLanes)) * sizeof(float);
+}
+
+template <int NumBands>
+void BandReverb<NumBands>::updateFeedbackGains()
+{
+    // Lines of different lengths need different gains to decay at the same
+    // rate: -60 dB after the decay time. Unused lanes stay at zero.
+    // Gains are the same for every channel, the stereo spread is only a few samples.
+    if (channels.empty())
+        return;
+
+    for (size_t line = 0; line < (size_t)numLines; ++line)
+    {
+        auto length = (float)channels[0].lines[line].length;
+
+        for (auto& gain : feedbackGains[line])
+            gain = Lanes::expand(0.0f);
+
+        for (size_t band = 0; band < (size_t)numBands; ++band)
+        {
+            feedbackGains[line][band / (size_t)numLanes].set(band % (size_t)numLanes,
+                std::pow(10.0f, -3.0f * length / (decayTimes[band] * (float)sampleRate)));
+        }
+    }
+}
+
+template <int NumBands>
+template <typename SampleType>
+void BandReverb<NumBands>::process(const BandBuffers<SampleType>& bands, juce::AudioBuffer<SampleType>& output)
+{
+    for (int channel = 0; channel < (int)channels.size(); ++channel)
+        processChannel(channel, bands, output);
+}
+
+template <int NumBands>
+template <typename SampleType>
+void BandReverb<NumBands>::processChannel(int channel, const BandBuffers<SampleType>& bands, juce::AudioBuffer<SampleType>& output) noexcept
+{
+    if (channel >= output.getNumChannels())
+        return;
+
+    auto& state = channels[(size_t)channel];
+    auto* out = output.getWritePointer(channel);
+    auto* scratch = state.scratch;
+    auto numSamples = output.getNumSamples();
+
+    // Locals keep the line state in registers for the loop
+    auto lines = state.lines;
+    const auto gains = feedbackGains;
+    const auto lowpassCoefficient = Lanes::expand(damping);
+    const auto inputCoefficient = Lanes::expand(1.0f - damping);
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        auto count = juce::jmin(chunkSize, numSamples - start);
+
+        // Interleave the bands into slots, the slots past numBands stay silent
+        for (int band = 0; band < numBands; ++band)
+        {
+            auto& buffer = bands[(size_t)band];
+
+            if (channel < buffer.getNumChannels())
+            {
+                auto* in = buffer.getReadPointer(channel, start);
+
+                for (int i = 0; i < count; ++i)
+                    scratch[i * numSlots + band] = (float)in[i];
+            }
+            else
+            {
+                for (int i = 0; i < count; ++i)
+                    scratch[i * numSlots + band] = 0.0f;
+            }
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto sum = Lanes::expand(0.0f);
+
+            for (int group = 0; group < numGroups; ++group)
+            {
+                auto x = Lanes::fromRawArray(scratch + i * numSlots + group * numLanes);
+
+                std::array<Lanes, numLines> y, lowpass;
+
+                for (size_t l = 0; l < (size_t)numLines; ++l)
+                {
+                    auto& line = lines[l];
+                    y[l] = Lanes::fromRawArray(line.data + line.position * numSlots + group * numLanes);
+
+                    // One-pole lowpass, high frequencies die out first
+                    auto& filter = line.lowpass[(size_t)group];
+                    filter = y[l] * inputCoefficient + filter * lowpassCoefficient;
+                    lowpass[l] = filter;
+                }
+
+                // Normalised 4x4 Hadamard matrix, lossless so the gains alone set the decay
+                auto a = lowpass[0] + lowpass[1];
+                auto b = lowpass[0] - lowpass[1];
+                auto c = lowpass[2] + lowpass[3];
+                auto d = lowpass[2] - lowpass[3];
+
+                std::array<Lanes, numLines> feedback{ (a + c) * 0.5f, (b + d) * 0.5f, (a - c) * 0.5f, (b - d) * 0.5f };
+
+                for (size_t l = 0; l < (size_t)numLines; ++l)
+                {
+                    auto& line = lines[l];
+                    (x + feedback[l] * gains[l][(size_t)group]).copyToRawArray(line.data + line.position * numSlots + group * numLanes);
+                }
+
+                sum = sum + (y[0] + y[1]) + (y[2] + y[3]);
+            }
+
+            for (auto& line : lines)
+            {
+                if (++line.position == line.length)
+                    line.position = 0;
+            }
+
+            // Sum of the lines, then of the bands
+            out[start + i] += (SampleType)(sum.sum() * outputGain);
+        }
+    }
+
+    state.lines = lines;
+}
+
+//==============================================================================
+#define BSD_INSTANTIATE_REVERB(numBands) \
+    template class BandReverb<numBands>; \
+    template void BandReverb<numBands>::process(const BandBuffers<float>&, juce::AudioBuffer<float>&); \
+    template void BandReverb<numBands>::process(const BandBuffers<double>&, juce::AudioBuffer<double>&); \
+    template void BandReverb<numBands>::processChannel(int, const BandBuffers<float>&, juce::AudioBuffer<float>&) noexcept; \
+    template void BandReverb<numBands>::processChannel(int, const BandBuffers<double>&, juce::AudioBuffer<double>&) noexcept;
+
+BSD_INSTANTIATE_REVERB(2)
+BSD_INSTANTIATE_REVERB(3)
+BSD_INSTANTIATE_REVERB(4)
+BSD_INSTANTIATE_REVERB(5)
+BSD_INSTANTIATE_REVERB(6)
+BSD_INSTANTIATE_REVERB(7)
+BSD_INSTANTIATE_REVERB(8)
+
+#undef BSD_INSTANTIATE_REVERB
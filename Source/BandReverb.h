@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    BandReverb.h
+
+    One feedback delay network that reverberates all bands at once.
+
+    Every channel has a four-line FDN with a Hadamard feedback matrix and a
+    one-pole damping filter per line. Each sample of a line holds the
+    bands side by side in the lanes of a SIMD register (or a few registers
+    when there are more bands than lanes), so the bands share every load,
+    store and matrix operation and only differ in their feedback gains,
+    which come from the per-band size. The lane outputs are summed and
+    added to the output buffer.
+
+    The lines always hold float, like a delay line's storage format. The
+    band and output buffers can be float or double, and are converted in
+    the interleaving and output passes the reverb makes anyway.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+template <int NumBands>
+class BandReverb
+{
+public:
+    static constexpr int numBands = NumBands;
+
+    template <typename SampleType>
+    using BandBuffers = std::array<juce::AudioBuffer<SampleType>, numBands>;
+
+    BandReverb() { decayTimes.fill(minDecaySeconds); }
+
+    // Allocates the delay lines, not realtime safe
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    // size is 0..1, mapped to a decay time between 0.5 and 10 seconds.
+    // Only recomputes the feedback gains when the size actually changes.
+    void setBandSize(int band, float size);
+
+    // Adds the reverb of every band to output
+    template <typename SampleType>
+    void process(const BandBuffers<SampleType>& bands, juce::AudioBuffer<SampleType>& output);
+
+    // Channels are independent, so they can be processed on different threads
+    int getNumChannels() const noexcept { return (int)channels.size(); }
+
+    template <typename SampleType>
+    void processChannel(int channel, const BandBuffers<SampleType>& bands, juce::AudioBuffer<SampleType>& output) noexcept;
+
+    size_t getMemoryFootprint() const noexcept;
+
+    // Longest decay time of the current band sizes, in seconds
+    float getDecayTime() const noexcept;
+
+private:
+   #if JUCE_USE_SIMD
+    using Lanes = juce::dsp::SIMDRegister<float>;
+   #else
+    // Stand-in with the same interface for builds without SIMD support
+    struct Lanes
+    {
+        static constexpr size_t SIMDNumElements = 4;
+        float v[SIMDNumElements];
+
+        static Lanes expand(float s) noexcept                  { Lanes r; for (auto& x : r.v) x = s; return r; }
+        static Lanes fromRawArray(const float* a) noexcept     { Lanes r; for (size_t i = 0; i < SIMDNumElements; ++i) r.v[i] = a[i]; return r; }
+        void copyToRawArray(float* a) const noexcept           { for (size_t i = 0; i < SIMDNumElements; ++i) a[i] = v[i]; }
+        void set(size_t i, float s) noexcept                   { v[i] = s; }
+        float sum() const noexcept                             { float s = 0; for (auto x : v) s += x; return s; }
+        Lanes operator+(Lanes o) const noexcept                { Lanes r; for (size_t i = 0; i < SIMDNumElements; ++i) r.v[i] = v[i] + o.v[i]; return r; }
+        Lanes operator-(Lanes o) const noexcept                { Lanes r; for (size_t i = 0; i < SIMDNumElements; ++i) r.v[i] = v[i] - o.v[i]; return r; }
+        Lanes operator*(Lanes o) const noexcept                { Lanes r; for (size_t i = 0; i < SIMDNumElements; ++i) r.v[i] = v[i] * o.v[i]; return r; }
+        Lanes operator*(float s) const noexcept                { Lanes r; for (size_t i = 0; i < SIMDNumElements; ++i) r.v[i] = v[i] * s; return r; }
+    };
+   #endif
+
+    static constexpr int numLines = 4;
+    static constexpr int numLanes = (int)Lanes::SIMDNumElements;
+
+    // Registers per line sample, bands past the last one leave their lanes silent
+    static constexpr int numGroups = (numBands + numLanes - 1) / numLanes;
+    static constexpr int numSlots = numGroups * numLanes;
+
+    static constexpr int chunkSize = 64;
+    static constexpr float damping = 0.3f;
+    static constexpr float outputGain = 0.35f;
+    static constexpr float minDecaySeconds = 0.5f;
+    static constexpr float maxDecaySeconds = 10.0f;
+
+    // A line stores numSlots floats per sample, one per band
+    struct Line
+    {
+        float* data{ nullptr };
+        int length{ 0 };
+        int position{ 0 };
+        std::array<Lanes, numGroups> lowpass{};
+    };
+
+    struct ChannelState
+    {
+        std::array<Line, numLines> lines;
+
+        // Interleaved [sample][slot] band input for one chunk
+        float* scratch{ nullptr };
+    };
+
+    void updateFeedbackGains();
+
+    std::vector<ChannelState> channels;
+    juce::HeapBlock<float> storage;
+    size_t storageSize{ 0 };
+
+    // Feedback gain of every line, per band lane
+    std::array<std::array<Lanes, numGroups>, numLines> feedbackGains{};
+    std::array<float, numBands> sizes{};
+    std::array<float, numBands> decayTimes;
+
+    juce::HeapBlock<float> scratchMemory;
+
+    double sampleRate{ 44100.0 };
+};
@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+    BandWorkerPool.cpp
+
+  ==============================================================================
+*/
+
+#include "BandWorkerPool.h"
+#include "RealtimeCheck.h"
+
+#include <thread>
+
+#if JUCE_LINUX
+ #include <cerrno>
+ #include <semaphore.h>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#endif
+
+//==============================================================================
+class BandWorkerPool::Semaphore
+{
+public:
+   #if JUCE_LINUX
+    Semaphore()         { sem_init(&semaphore, 0, 0); }
+    ~Semaphore()        { sem_destroy(&semaphore); }
+    void signal()       { sem_post(&semaphore); }
+    void wait()         { while (sem_wait(&semaphore) != 0 && errno == EINTR) {} }
+
+   private:
+    sem_t semaphore;
+   #elif JUCE_MAC || JUCE_IOS
+    Semaphore()         : semaphore(dispatch_semaphore_create(0)) {}
+    ~Semaphore()        { dispatch_release(semaphore); }
+    void signal()       { dispatch_semaphore_signal(semaphore); }
+    void wait()         { dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER); }
+
+   private:
+    dispatch_semaphore_t semaphore;
+   #else
+    // Polls, since an auto-reset event can merge signals meant for different workers
+    void signal()       { count.fetch_add(1); event.signal(); }
+
+    void wait()
+    {
+        for (;;)
+        {
+            auto available = count.load();
+
+            if (available > 0 && count.compare_exchange_weak(available, available - 1))
+                return;
+
+            event.wait(1);
+        }
+    }
+
+   private:
+    std::atomic<int> count{ 0 };
+    juce::WaitableEvent event;
+   #endif
+};
+
+//==============================================================================
+class BandWorkerPool::Worker : public juce::Thread
+{
+public:
+    explicit Worker(BandWorkerPool& p) : juce::Thread("BandSplitDelay worker"), pool(p) {}
+
+    void run() override
+    {
+        for (;;)
+        {
+            pool.wakeUp->wait();
+
+            if (threadShouldExit())
+                return;
+
+            RealtimeCheck::ScopedRealtimeSection realtimeSection;
+            juce::ScopedNoDenormals noDenormals;
+            pool.executeJobs();
+        }
+    }
+
+private:
+    BandWorkerPool& pool;
+};
+
+//==============================================================================
+BandWorkerPool::BandWorkerPool(int numWorkers)
+    : wakeUp(std::make_unique<Semaphore>())
+{
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(*this));
+
+       #if JUCE_VERSION >= 0x70003
+        workers.back()->startRealtimeThread(juce::Thread::RealtimeOptions{});
+       #else
+        workers.back()->startThread(10);
+       #endif
+    }
+}
+
+BandWorkerPool::~BandWorkerPool()
+{
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+
+    for (size_t i = 0; i < workers.size(); ++i)
+        wakeUp->signal();
+
+    for (auto& worker : workers)
+        worker->stopThread(1000);
+}
+
+void BandWorkerPool::runJobs(int numJobs, JobFunction function, void* context) noexcept
+{
+    if (numJobs <= 0)
+        return;
+
+    if (workers.empty() || numJobs == 1)
+    {
+        for (int i = 0; i < numJobs; ++i)
+            function(context, i);
+
+        return;
+    }
+
+    jassert(numJobs <= 0xffff);
+
+    jobFunction = function;
+    jobContext = context;
+
+    auto numToWake = juce::jmin((int)workers.size(), numJobs - 1);
+
+    unfinishedJobs.store(numJobs, std::memory_order_relaxed);
+    batch.store(((juce::uint64)++generation << 32) | ((juce::uint64)numJobs << 16), std::memory_order_release);
+
+    for (int i = 0; i < numToWake; ++i)
+        wakeUp->signal();
+
+    executeJobs();
+
+    // Join: every job is claimed by now and the rest are already running,
+    // so this is short. Workers that haven't woken yet find the batch done.
+    while (unfinishedJobs.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+}
+
+void BandWorkerPool::executeJobs() noexcept
+{
+    auto state = batch.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        auto index = (int)(state & 0xffff);
+        auto numJobs = (int)((state >> 16) & 0xffff);
+
+        if (index >= numJobs)
+            return;
+
+        // Fails and reloads state if another thread claimed first or a new
+        // batch started. Once it succeeds the batch can't finish before
+        // this job does, so jobFunction and jobContext stay valid.
+        if (!batch.compare_exchange_weak(state, state + 1, std::memory_order_acquire))
+            continue;
+
+        jobFunction(jobContext, index);
+        unfinishedJobs.fetch_sub(1, std::memory_order_release);
+        ++state;
+    }
+}
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    BandWorkerPool.h
+
+    A few realtime-priority threads that help the audio thread with
+    independent jobs, such as one band's delay or one channel's reverb.
+
+    run() is a fork/join: the calling thread wakes the workers, takes jobs
+    itself, then spins until the jobs other threads took have finished.
+    Jobs are claimed from an atomic counter and workers are woken with a
+    native semaphore (futex on Linux, dispatch on Apple), so the audio
+    thread never locks a mutex or allocates. Other platforms fall back to
+    a WaitableEvent.
+
+    Waking threads costs a few microseconds, it only pays off for large
+    blocks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class BandWorkerPool
+{
+public:
+    // Starts numWorkers threads, not realtime safe
+    explicit BandWorkerPool(int numWorkers);
+    ~BandWorkerPool();
+
+    int getNumWorkers() const noexcept { return (int)workers.size(); }
+
+    // Calls job(index) for every index in [0, numJobs) across the workers
+    // and the calling thread, and returns once all of them have finished.
+    template <typename Job>
+    void run(int numJobs, Job& job) noexcept
+    {
+        runJobs(numJobs, [](void* context, int index) { (*static_cast<Job*>(context))(index); }, &job);
+    }
+
+private:
+    using JobFunction = void (*)(void* context, int index);
+
+    class Semaphore;
+    class Worker;
+
+    void runJobs(int numJobs, JobFunction function, void* context) noexcept;
+    void executeJobs() noexcept;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::unique_ptr<Semaphore> wakeUp;
+
+    // The current batch, published by the release store of batch
+    JobFunction jobFunction{ nullptr };
+    void* jobContext{ nullptr };
+
+    // Batch generation, job count and next job index in one word. Jobs are
+    // claimed with a compare and swap on it, so a worker that wakes up late
+    // can only claim a job of the batch that is running, and run() doesn't
+    // have to wait for workers that find nothing left to do.
+    std::atomic<juce::uint64> batch{ 0 };
+    juce::uint32 generation{ 0 };
+    std::atomic<int> unfinishedJobs{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(BandWorkerPool)
+};
@@ -0,0 +1,321 @@
+/*
+  ==============================================================================
+
+    Crossover.cpp
+
+  ==============================================================================
+*/
+
+#include "Crossover.h"
+
+namespace {
+
+    // One second order TPT state-variable section, as in juce::dsp::LinkwitzRileyFilter.
+    // Written with the value on the left so it works for scalars and SIMDRegisters.
+    template <typename Value>
+    struct SVFOutputs { Value hp, bp, lp; };
+
+    template <typename Value, typename Scalar>
+    inline SVFOutputs<Value> tick(Value input, Value& s1, Value& s2, Scalar g, Scalar h, Scalar R2g) noexcept
+    {
+        SVFOutputs<Value> y;
+        y.hp = (input - s1 * R2g - s2) * h;
+        y.bp = y.hp * g + s1;
+        s1 = y.hp * g + y.bp;
+        y.lp = y.bp * g + s2;
+        s2 = y.bp * g + y.lp;
+        return y;
+    }
+
+    // Peels one band off per split, see Crossover.h. NumBands is a
+    // compile-time constant so the loops unroll into a fixed tree.
+    template <int NumBands, typename Value, typename State, typename CoefficientArray>
+    inline void splitSample(State& s, Value x, std::array<Value, NumBands>& out, const CoefficientArray& c) noexcept
+    {
+        constexpr auto R2 = juce::MathConstants<typename CoefficientArray::value_type::ValueType>::sqrt2;
+
+        auto upper = x;
+        auto allpass = 0;
+
+        for (int k = 0; k < NumBands - 1; ++k)
+        {
+            const auto& ck = c[(size_t)k];
+            auto& split = s.split[(size_t)k];
+            auto a = tick(upper, split[0], split[1], ck.g, ck.h, ck.R2g);
+            auto a2 = tick(a.lp, split[2], split[3], ck.g, ck.h, ck.R2g);
+
+            // Phase compensation of the bands already split off below
+            for (int j = 0; j < k; ++j)
+            {
+                auto& ap = s.allpass[(size_t)allpass++];
+                auto b = tick(out[(size_t)j], ap[0], ap[1], ck.g, ck.h, ck.R2g);
+                out[(size_t)j] = b.lp - b.bp * R2 + b.hp;
+            }
+
+            out[(size_t)k] = a2.lp;
+            upper = a.lp - a.bp * R2 + a.hp - a2.lp;
+        }
+
+        out[(size_t)(NumBands - 1)] = upper;
+    }
+}
+
+//==============================================================================
+template <int NumBands, typename SampleType>
+void BandCrossover<NumBands, SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    jassert(spec.sampleRate > 0);
+    jassert(spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    channelStates.resize(spec.numChannels);
+
+    table.prepare(sampleRate);
+    glideSchedule.resize(juce::jmax((size_t)1, (size_t)spec.maximumBlockSize));
+    frequencies.fill(-1.0f);
+
+   #if JUCE_USE_SIMD
+    useSIMD = spec.numChannels >= 2;
+
+    if (useSIMD)
+    {
+        auto numGroups = ((int)spec.numChannels + simdLanes - 1) / simdLanes;
+        groupStates.resize((size_t)numGroups);
+
+        // Room for the interleaved input and band chunks plus alignment slack
+        scratchMemory.allocate((size_t)((NumBands + 1) * simdChunkSize * simdLanes + simdLanes), true);
+        scratch = SIMDValue::getNextSIMDAlignedPtr(scratchMemory.get());
+    }
+   #endif
+
+    reset();
+}
+
+template <int NumBands, typename SampleType>
+void BandCrossover<NumBands, SampleType>::reset()
+{
+    std::fill(channelStates.begin(), channelStates.end(), FilterState<SampleType>{});
+
+   #if JUCE_USE_SIMD
+    std::fill(groupStates.begin(), groupStates.end(), FilterState<SIMDValue>{});
+   #endif
+
+    // Cleared filters have nothing to glide across, so the next frequencies
+    // are set right away. A crossover that sat unused while they changed
+    // starts from the current ones instead of gliding from stale ones.
+    hasFrequencies = false;
+    glidePending = false;
+    glidingSplits.fill(false);
+}
+
+template <int NumBands, typename SampleType>
+void BandCrossover<NumBands, SampleType>::setCrossoverFrequencies(const std::array<float, numSplits>& newFrequencies)
+{
+    for (size_t k = 0; k < (size_t)numSplits; ++k)
+    {
+        auto frequency = juce::jlimit(CrossoverCoefficientTable::minFrequency, table.getHighestFrequency(), newFrequencies[k]);
+
+        if (frequency == frequencies[k])
+            continue;
+
+        frequencies[k] = frequency;
+        targetPositions[k] = table.getPosition(frequency);
+
+        if (hasFrequencies)
+        {
+            glidingSplits[k] = true;
+            glidePending = true;
+        }
+        else
+        {
+            coefficients[k].setCutoff(frequency, sampleRate);
+            positions[k] = targetPositions[k];
+            glidingSplits[k] = false;
+        }
+    }
+
+    hasFrequencies = true;
+}
+
+template <int NumBands, typename SampleType>
+int BandCrossover<NumBands, SampleType>::prepareGlide(int numSamples) noexcept
+{
+    if (!glidePending)
+        return 0;
+
+    // Position on the table moves linearly over the block, so the cutoffs
+    // move evenly in log frequency. Splits that didn't change keep their
+    // exact coefficients, and the moving ones land on theirs on the last
+    // sample, so nothing steps between the table and the exact values.
+    auto length = juce::jmin(numSamples, (int)glideSchedule.size());
+
+    for (size_t k = 0; k < (size_t)numSplits; ++k)
+    {
+        if (glidingSplits[k])
+            coefficients[k].setCutoff(frequencies[k], sampleRate);
+    }
+
+    for (int i = 0; i < length; ++i)
+    {
+        auto amount = (float)(i + 1) / (float)length;
+
+        for (size_t k = 0; k < (size_t)numSplits; ++k)
+        {
+            glideSchedule[(size_t)i][k] = glidingSplits[k] && i < length - 1
+                                        ? table.getCoefficients<SampleType>(positions[k] + (targetPositions[k] - positions[k]) * amount)
+                                        : coefficients[k];
+        }
+    }
+
+    positions = targetPositions;
+    glidingSplits.fill(false);
+    glidePending = false;
+    return length;
+}
+
+template <int NumBands, typename SampleType>
+void BandCrossover<NumBands, SampleType>::process(const juce::AudioBuffer<SampleType>& input, BandBuffers& bands)
+{
+    auto numChannels = juce::jmin(input.getNumChannels(), (int)channelStates.size());
+    auto numSamples = input.getNumSamples();
+
+    for (auto& band : bands)
+    {
+        jassert(band.getNumChannels() >= numChannels);
+        jassert(band.getNumSamples() >= numSamples);
+    }
+
+    auto scheduleLength = prepareGlide(numSamples);
+    auto* schedule = scheduleLength > 0 ? glideSchedule.data() : nullptr;
+
+   #if JUCE_USE_SIMD
+    if (useSIMD)
+    {
+        for (int firstChannel = 0, group = 0; firstChannel < numChannels; firstChannel += simdLanes, ++group)
+        {
+            processGroup(groupStates[(size_t)group], input, bands, firstChannel,
+                         juce::jmin(simdLanes, numChannels - firstChannel), numSamples, schedule, scheduleLength);
+        }
+
+        return;
+    }
+   #endif
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        std::array<SampleType*, NumBands> outputs;
+
+        for (size_t band = 0; band < (size_t)NumBands; ++band)
+            outputs[band] = bands[band].getWritePointer(channel);
+
+        processChannel(channelStates[(size_t)channel], input.getReadPointer(channel), outputs, numSamples, schedule, scheduleLength);
+    }
+}
+
+template <int NumBands, typename SampleType>
+void BandCrossover<NumBands, SampleType>::processChannel(FilterState<SampleType>& state, const SampleType* input,
+                                                         const std::array<SampleType*, NumBands>& bands, int numSamples,
+                                                         const Coefficients* schedule, int scheduleLength) const noexcept
+{
+    // Copies keep the whole filter state in registers for the loop
+    auto s = state;
+    const auto c = coefficients;
+
+    auto tickSample = [&](int i, const Coefficients& sampleCoefficients)
+    {
+        std::array<SampleType, NumBands> out;
+        splitSample<NumBands>(s, input[i], out, sampleCoefficients);
+
+        for (size_t band = 0; band < (size_t)NumBands; ++band)
+            bands[band][i] = out[band];
+    };
+
+    for (int i = 0; i < scheduleLength; ++i)
+        tickSample(i, schedule[i]);
+
+    for (int i = scheduleLength; i < numSamples; ++i)
+        tickSample(i, c);
+
+    state = s;
+}
+
+#if JUCE_USE_SIMD
+template <int NumBands, typename SampleType>
+void BandCrossover<NumBands, SampleType>::processGroup(FilterState<SIMDValue>& state, const juce::AudioBuffer<SampleType>& input, BandBuffers& bands,
+                                                       int firstChannel, int numChannels, int numSamples,
+                                                       const Coefficients* schedule, int scheduleLength) noexcept
+{
+    auto s = state;
+    const auto c = coefficients;
+
+    // The input chunk first, then one chunk per band
+    auto* in = scratch;
+    auto getBandScratch = [this](int band) { return scratch + (band + 1) * simdChunkSize * simdLanes; };
+
+    for (int start = 0; start < numSamples; start += simdChunkSize)
+    {
+        auto chunkSize = juce::jmin(simdChunkSize, numSamples - start);
+
+        // Unused lanes of a partial group filter silence
+        if (numChannels < simdLanes)
+            juce::FloatVectorOperations::clear(in, chunkSize * simdLanes);
+
+        for (int lane = 0; lane < numChannels; ++lane)
+        {
+            auto* source = input.getReadPointer(firstChannel + lane, start);
+
+            for (int i = 0; i < chunkSize; ++i)
+                in[i * simdLanes + lane] = source[i];
+        }
+
+        auto tickSample = [&](int i, const Coefficients& sampleCoefficients)
+        {
+            std::array<SIMDValue, NumBands> out;
+            splitSample<NumBands>(s, SIMDValue::fromRawArray(in + i * simdLanes), out, sampleCoefficients);
+
+            for (int band = 0; band < NumBands; ++band)
+                out[(size_t)band].copyToRawArray(getBandScratch(band) + i * simdLanes);
+        };
+
+        // The part of the chunk still gliding, then the rest
+        auto numGliding = juce::jlimit(0, chunkSize, scheduleLength - start);
+
+        for (int i = 0; i < numGliding; ++i)
+            tickSample(i, schedule[start + i]);
+
+        for (int i = numGliding; i < chunkSize; ++i)
+            tickSample(i, c);
+
+        for (int band = 0; band < NumBands; ++band)
+        {
+            auto* bandScratch = getBandScratch(band);
+
+            for (int lane = 0; lane < numChannels; ++lane)
+            {
+                auto* output = bands[(size_t)band].getWritePointer(firstChannel + lane, start);
+
+                for (int i = 0; i < chunkSize; ++i)
+                    output[i] = bandScratch[i * simdLanes + lane];
+            }
+        }
+    }
+
+    state = s;
+}
+#endif
+
+//==============================================================================
+template class BandCrossover<2, float>;
+template class BandCrossover<3, float>;
+template class BandCrossover<4, float>;
+template class BandCrossover<5, float>;
+template class BandCrossover<6, float>;
+template class BandCrossover<7, float>;
+template class BandCrossover<8, float>;
+template class BandCrossover<2, double>;
+template class BandCrossover<3, double>;
+template class BandCrossover<4, double>;
+template class BandCrossover<5, double>;
+template class BandCrossover<6, double>;
+template class BandCrossover<7, double>;
+template class BandCrossover<8, double>;
@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    Crossover.h
+
+    Linkwitz-Riley crossover that splits every input sample into NumBands
+    bands (2 to 8) in a single pass.
+
+    Same sections as juce::dsp::LinkwitzRileyFilter (two cascaded TPT
+    state-variable filters per split), arranged as a tree that peels one
+    band off the bottom at each crossover frequency f1 < f2 < ...:
+
+        band 0   = LP(f1) (x)
+        band 1   = LP(f2) ( HP(f1) (x) )
+        ...
+        band N-1 = HP(fN-1) ( ... HP(f1) (x) )
+
+    Every band that was split off below fk also goes through the allpass
+    at fk, so all bands stay phase aligned and sum to an allpassed copy of
+    the input. For three bands that is
+
+        low  = AP(f2) ( LP(f1) (x) )
+        mid  = LP(f2) ( HP(f1) (x) )
+        high = HP(f2) ( HP(f1) (x) )
+
+    The band count is a template parameter, so the tree and the number of
+    allpass sections are fixed at compile time and the inner loop has no
+    branches on it.
+
+    Coefficients are only recomputed for a crossover frequency that
+    actually changed. A change glides over the next block, sample by
+    sample, along a CrossoverCoefficientTable instead of jumping, and ends
+    on the exact coefficients. The other splits keep theirs throughout.
+
+    With two or more channels the channels are packed into the lanes of a
+    juce::dsp::SIMDRegister and filtered together. The instruction set of
+    SIMDRegister is fixed when JUCE is compiled (SSE2/NEON, or AVX2 with
+    BSD_ENABLE_AVX2), mono and non-SIMD builds use the scalar kernel.
+
+    SampleType is float or double. The filter state, the coefficients and
+    the buffers all use it, so a double host gets double filters and no
+    conversions, with half as many channels per register.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CrossoverCoefficients.h"
+
+template <int NumBands, typename SampleType = float>
+class BandCrossover
+{
+public:
+    static_assert(NumBands >= 2 && NumBands <= 8, "2 to 8 bands are supported");
+
+    static constexpr int numBands = NumBands;
+    static constexpr int numSplits = NumBands - 1;
+
+    using BandBuffers = std::array<juce::AudioBuffer<SampleType>, NumBands>;
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    // Clears the filters, the next frequencies are set without a glide
+    void reset();
+
+    // Crossover frequencies from low to high. Cheap when nothing changed.
+    void setCrossoverFrequencies(const std::array<float, numSplits>& frequencies);
+
+    // Reads every sample of input once and writes all bands.
+    // The band buffers must hold at least input's channels and samples;
+    // input may be the same buffer as one of the bands.
+    void process(const juce::AudioBuffer<SampleType>& input, BandBuffers& bands);
+
+    bool isUsingSIMD() const noexcept { return useSIMD; }
+
+private:
+    using Coefficients = std::array<SVFCoefficients<SampleType>, numSplits>;
+
+    // Filter memory of one channel (scalar) or one group of channels (SIMD),
+    // loaded into locals for the inner loop
+    template <typename Value>
+    struct FilterState
+    {
+        // Bands below split k pass through its allpass, k of them per split
+        static constexpr int numAllpasses = numSplits * (numSplits - 1) / 2;
+
+        // Two cascaded sections per split
+        std::array<std::array<Value, 4>, numSplits> split{};
+        std::array<std::array<Value, 2>, std::max(1, numAllpasses)> allpass{};
+    };
+
+    // schedule holds per-sample coefficients for the first scheduleLength
+    // samples while a frequency glides, the rest use coefficients
+    void processChannel(FilterState<SampleType>& state, const SampleType* input, const std::array<SampleType*, NumBands>& bands, int numSamples,
+                        const Coefficients* schedule, int scheduleLength) const noexcept;
+
+    int prepareGlide(int numSamples) noexcept;
+
+    Coefficients coefficients;
+    CrossoverCoefficientTable table;
+
+    // Last frequencies set, and where the glide starts and ends on the table
+    std::array<float, numSplits> frequencies{};
+    std::array<float, numSplits> positions{};
+    std::array<float, numSplits> targetPositions{};
+    std::array<bool, numSplits> glidingSplits{};
+    bool hasFrequencies{ false };
+    bool glidePending{ false };
+    std::vector<Coefficients> glideSchedule;
+
+    std::vector<FilterState<SampleType>> channelStates;
+    double sampleRate{ 44100.0 };
+    bool useSIMD{ false };
+
+   #if JUCE_USE_SIMD
+    using SIMDValue = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int simdLanes = (int)SIMDValue::SIMDNumElements;
+    static constexpr int simdChunkSize = 64;
+
+    void processGroup(FilterState<SIMDValue>& state, const juce::AudioBuffer<SampleType>& input, BandBuffers& bands,
+                      int firstChannel, int numChannels, int numSamples,
+                      const Coefficients* schedule, int scheduleLength) noexcept;
+
+    std::vector<FilterState<SIMDValue>> groupStates;
+
+    // Interleaved [sample][lane] scratch for the input and every band
+    juce::HeapBlock<SampleType> scratchMemory;
+    SampleType* scratch{ nullptr };
+   #endif
+};
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    CrossoverCoefficients.cpp
+
+  ==============================================================================
+*/
+
+#include "CrossoverCoefficients.h"
+
+namespace {
+
+    // log2(maxFrequency / minFrequency)
+    const float octaveRange = std::log2(CrossoverCoefficientTable::maxFrequency / CrossoverCoefficientTable::minFrequency);
+}
+
+//==============================================================================
+template <typename Type>
+void SVFCoefficients<Type>::setCutoff(float cutoff, double sampleRate) noexcept
+{
+    setG((Type)std::tan(juce::MathConstants<double>::pi * cutoff / sampleRate));
+}
+
+template <typename Type>
+void SVFCoefficients<Type>::setG(Type newG) noexcept
+{
+    constexpr auto R2 = juce::MathConstants<Type>::sqrt2;
+
+    g = newG;
+    h = (Type)1 / ((Type)1 + R2 * g + g * g);
+    R2g = R2 + g;
+}
+
+template struct SVFCoefficients<float>;
+template struct SVFCoefficients<double>;
+
+//==============================================================================
+void CrossoverCoefficientTable::prepare(double sampleRate)
+{
+    jassert(sampleRate > 0);
+
+    highestFrequency = juce::jmin(maxFrequency, (float)(sampleRate * 0.49));
+    gTable.resize((size_t)tableSize);
+
+    for (int i = 0; i < tableSize; ++i)
+    {
+        auto frequency = minFrequency * std::exp2(octaveRange * (float)i / (float)(tableSize - 1));
+        frequency = juce::jmin(frequency, highestFrequency);
+
+        gTable[(size_t)i] = (float)std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    }
+}
+
+float CrossoverCoefficientTable::getPosition(float frequency) const noexcept
+{
+    frequency = juce::jlimit(minFrequency, highestFrequency, frequency);
+    return std::log2(frequency / minFrequency) / octaveRange * (float)(tableSize - 1);
+}
+
+template <typename Type>
+SVFCoefficients<Type> CrossoverCoefficientTable::getCoefficients(float position) const noexcept
+{
+    jassert(!gTable.empty());
+
+    position = juce::jlimit(0.0f, (float)(tableSize - 1), position);
+
+    auto index = juce::jmin((int)position, tableSize - 2);
+    auto fraction = position - (float)index;
+
+    SVFCoefficients<Type> coefficients;
+    coefficients.setG((Type)(gTable[(size_t)index] + (gTable[(size_t)index + 1] - gTable[(size_t)index]) * fraction));
+    return coefficients;
+}
+
+template SVFCoefficients<float> CrossoverCoefficientTable::getCoefficients<float>(float) const noexcept;
+template SVFCoefficients<double> CrossoverCoefficientTable::getCoefficients<double>(float) const noexcept;
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    CrossoverCoefficients.h
+
+    Coefficients of one TPT state-variable section, and a table of them
+    over 20 Hz - 20 kHz for cutoffs that move every sample.
+
+    The table holds g = tan(pi f / fs) at log-spaced frequencies. Looking
+    a cutoff up is a linear interpolation in log frequency plus one
+    division, no tan(). Positions along the table are linear in log
+    frequency, so a ramp between two cutoffs is a linear ramp of positions
+    and needs no log() per sample either. The interpolated g is within
+    about 0.1% of the exact value.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// In the precision of the filter that uses them, float or double
+template <typename Type>
+struct SVFCoefficients
+{
+    using ValueType = Type;
+
+    // Exact, calls tan()
+    void setCutoff(float cutoff, double sampleRate) noexcept;
+    void setG(Type newG) noexcept;
+
+    Type g{ 0 };
+    Type h{ 0 };
+    Type R2g{ 0 };
+};
+
+class CrossoverCoefficientTable
+{
+public:
+    static constexpr float minFrequency = 20.0f;
+    static constexpr float maxFrequency = 20000.0f;
+    static constexpr int tableSize = 1024;
+
+    // Fills the table, not realtime safe
+    void prepare(double sampleRate);
+
+    // Cutoffs are clamped to 20 Hz - 20 kHz and below Nyquist
+    float getPosition(float frequency) const noexcept;
+    template <typename Type>
+    SVFCoefficients<Type> getCoefficients(float position) const noexcept;
+
+    // Frequency limit for this sample rate, the bilinear prewarp blows up at sampleRate / 2
+    float getHighestFrequency() const noexcept { return highestFrequency; }
+
+private:
+    std::vector<float> gTable;
+    float highestFrequency{ maxFrequency };
+};
@@ -0,0 +1,415 @@
+/*
+  ==============================================================================
+
+    DelayLine.cpp
+
+  ==============================================================================
+*/
+
+#include "DelayLine.h"
+
+#if JUCE_LINUX
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
+
+namespace {
+
+    // IEEE half precision, round to nearest, keeps subnormals
+    inline juce::uint16 floatToHalf(float value) noexcept
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        auto sign = (juce::uint32)((bits >> 16) & 0x8000);
+        auto exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+        auto mantissa = bits & 0x7fffff;
+
+        if (exponent <= 0)
+        {
+            if (exponent < -10)
+                return (juce::uint16)sign;
+
+            mantissa |= 0x800000;
+            auto shift = 14 - exponent;
+            auto half = mantissa >> shift;
+
+            if ((mantissa >> (shift - 1)) & 1)
+                ++half;
+
+            return (juce::uint16)(sign | half);
+        }
+
+        // Clamp instead of producing infinity
+        if (exponent >= 31)
+            return (juce::uint16)(sign | 0x7bff);
+
+        auto half = sign | ((juce::uint32)exponent << 10) | (mantissa >> 13);
+
+        if (mantissa & 0x1000)
+            ++half;
+
+        return (juce::uint16)juce::jmin(half, sign | 0x7bffu);
+    }
+
+    inline float halfToFloat(juce::uint16 half) noexcept
+    {
+        auto sign = (juce::uint32)(half & 0x8000) << 16;
+        auto exponent = (juce::uint32)(half >> 10) & 0x1f;
+        auto mantissa = (juce::uint32)half & 0x3ff;
+
+        if (exponent == 0)
+        {
+            auto value = (float)mantissa * 5.9604644775390625e-8f; // 2^-24
+            return sign != 0 ? -value : value;
+        }
+
+        auto bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // The integer formats store the signal 12 dB down, so feedback and wet
+    // signal above 0 dBFS aren't clipped where the float formats keep them
+    constexpr float integerHeadroom = 4.0f;
+    constexpr float int16Scale = 32767.0f / integerHeadroom;
+    constexpr float int24Scale = 8388607.0f / integerHeadroom;
+
+    inline float readInt24(const char* data) noexcept
+    {
+        auto* bytes = reinterpret_cast<const juce::uint8*>(data);
+        auto value = (juce::int32)((juce::uint32)bytes[0] | ((juce::uint32)bytes[1] << 8) | ((juce::uint32)bytes[2] << 16));
+
+        // Sign-extend from 24 bits
+        value = (value ^ 0x800000) - 0x800000;
+        return (float)value / int24Scale;
+    }
+
+    inline void writeInt24(char* data, float sample) noexcept
+    {
+        auto value = (juce::int32)juce::roundToInt(juce::jlimit(-integerHeadroom, integerHeadroom, sample) * int24Scale);
+        auto* bytes = reinterpret_cast<juce::uint8*>(data);
+
+        bytes[0] = (juce::uint8)(value & 0xff);
+        bytes[1] = (juce::uint8)((value >> 8) & 0xff);
+        bytes[2] = (juce::uint8)((value >> 16) & 0xff);
+    }
+
+    // Plain copy when the types match, a converting loop otherwise
+    template <typename Dest, typename Source>
+    inline void copyConverted(Dest* dest, const Source* source, int numSamples) noexcept
+    {
+        if constexpr (std::is_same_v<Dest, Source>)
+        {
+            juce::FloatVectorOperations::copy(dest, source, numSamples);
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] = (Dest)source[i];
+        }
+    }
+}
+
+//==============================================================================
+int DelayLine::getBytesPerSample(SampleFormat format) noexcept
+{
+    switch (format)
+    {
+    case SampleFormat::float16: return 2;
+    case SampleFormat::int16:   return 2;
+    case SampleFormat::int24:   return 3;
+    case SampleFormat::float64: return 8;
+    case SampleFormat::float32:
+    default:                    return 4;
+    }
+}
+
+juce::String DelayLine::getFormatName(SampleFormat format)
+{
+    switch (format)
+    {
+    case SampleFormat::float16: return "float16";
+    case SampleFormat::int16:   return "int16";
+    case SampleFormat::int24:   return "int24";
+    case SampleFormat::float64: return "float64";
+    case SampleFormat::float32:
+    default:                    return "float32";
+    }
+}
+
+bool DelayLine::getFormatFromName(const juce::String& name, SampleFormat& result)
+{
+    for (auto candidate : { SampleFormat::float32, SampleFormat::float16, SampleFormat::int16, SampleFormat::int24, SampleFormat::float64 })
+    {
+        if (name == getFormatName(candidate))
+        {
+            result = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//==============================================================================
+DelayLine::~DelayLine()
+{
+    release();
+}
+
+void DelayLine::setSize(int newNumChannels, int minimumCapacity, SampleFormat newFormat, bool tryMirroring)
+{
+    jassert(newNumChannels > 0 && minimumCapacity > 0);
+
+    release();
+
+    numChannels = newNumChannels;
+    capacity = juce::nextPowerOfTwo(minimumCapacity);
+    format = newFormat;
+    bytesPerSample = getBytesPerSample(format);
+
+    if (tryMirroring && allocateMirrored())
+    {
+        mirrored = true;
+    }
+    else
+    {
+        stride = capacity;
+        heapMemory.allocate((size_t)numChannels * (size_t)capacity * (size_t)bytesPerSample, true);
+        channels = heapMemory.get();
+    }
+
+    clear();
+}
+
+void DelayLine::release()
+{
+   #if JUCE_LINUX
+    if (mappedMemory != nullptr)
+        munmap(mappedMemory, mappedSize);
+   #endif
+
+    mappedMemory = nullptr;
+    mappedSize = 0;
+    heapMemory.free();
+
+    channels = nullptr;
+    numChannels = 0;
+    capacity = 0;
+    stride = 0;
+    mirrored = false;
+}
+
+void DelayLine::clear()
+{
+    // All formats encode silence as zero bytes
+    for (int channel = 0; channel < numChannels; ++channel)
+        std::memset(getChannel(channel), 0, (size_t)capacity * (size_t)bytesPerSample);
+}
+
+bool DelayLine::allocateMirrored()
+{
+   #if JUCE_LINUX
+    // Each view has to start on a page boundary. A power-of-two capacity of
+    // at least one page worth of samples is a whole number of pages for
+    // every sample size.
+    auto pageSize = (int)sysconf(_SC_PAGESIZE);
+    if (pageSize <= 0)
+        return false;
+
+    capacity = juce::jmax(capacity, juce::nextPowerOfTwo(pageSize));
+
+    auto channelBytes = (size_t)capacity * (size_t)bytesPerSample;
+    auto fileSize = channelBytes * (size_t)numChannels;
+
+    auto fd = memfd_create("BandSplitDelay", MFD_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    if (ftruncate(fd, (off_t)fileSize) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    // Reserve the whole address range first so both views land side by side
+    auto reservedSize = fileSize * 2;
+    auto* base = static_cast<char*>(mmap(nullptr, reservedSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+    if (base == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    auto ok = true;
+
+    for (int channel = 0; channel < numChannels && ok; ++channel)
+    {
+        auto* channelStart = base + (size_t)channel * channelBytes * 2;
+        auto offset = (off_t)((size_t)channel * channelBytes);
+
+        for (auto* view : { channelStart, channelStart + channelBytes })
+        {
+            if (mmap(view, channelBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, offset) == MAP_FAILED)
+                ok = false;
+        }
+    }
+
+    close(fd);
+
+    if (!ok)
+    {
+        munmap(base, reservedSize);
+        return false;
+    }
+
+    mappedMemory = base;
+    mappedSize = reservedSize;
+    channels = base;
+    stride = capacity * 2;
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+//==============================================================================
+template <typename SampleType>
+void DelayLine::writeSpan(char* dest, const SampleType* source, int numSamples) const noexcept
+{
+    switch (format)
+    {
+    case SampleFormat::float32:
+        copyConverted(reinterpret_cast<float*>(dest), source, numSamples);
+        break;
+
+    case SampleFormat::float64:
+        copyConverted(reinterpret_cast<double*>(dest), source, numSamples);
+        break;
+
+    case SampleFormat::float16:
+    {
+        auto* d = reinterpret_cast<juce::uint16*>(dest);
+        for (int i = 0; i < numSamples; ++i)
+            d[i] = floatToHalf((float)source[i]);
+        break;
+    }
+
+    case SampleFormat::int16:
+    {
+        auto* d = reinterpret_cast<juce::int16*>(dest);
+        for (int i = 0; i < numSamples; ++i)
+            d[i] = (juce::int16)juce::roundToInt(juce::jlimit(-integerHeadroom, integerHeadroom, (float)source[i]) * int16Scale);
+        break;
+    }
+
+    case SampleFormat::int24:
+        for (int i = 0; i < numSamples; ++i)
+            writeInt24(dest + i * 3, (float)source[i]);
+        break;
+    }
+}
+
+template <typename SampleType>
+void DelayLine::addSpan(SampleType* dest, const char* source, int numSamples, SampleType gain, SampleType increment) const noexcept
+{
+    constexpr auto nativeFormat = std::is_same_v<SampleType, double> ? SampleFormat::float64 : SampleFormat::float32;
+
+    if (format == nativeFormat && increment == (SampleType)0)
+    {
+        juce::FloatVectorOperations::addWithMultiply(dest, reinterpret_cast<const SampleType*>(source), gain, numSamples);
+        return;
+    }
+
+    auto process = [&](auto&& readSample)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] += (SampleType)readSample(i) * (gain + increment * (SampleType)i);
+    };
+
+    switch (format)
+    {
+    case SampleFormat::float32:
+    {
+        auto* s = reinterpret_cast<const float*>(source);
+        process([s](int i) { return s[i]; });
+        break;
+    }
+
+    case SampleFormat::float64:
+    {
+        auto* s = reinterpret_cast<const double*>(source);
+        process([s](int i) { return s[i]; });
+        break;
+    }
+
+    case SampleFormat::float16:
+    {
+        auto* s = reinterpret_cast<const juce::uint16*>(source);
+        process([s](int i) { return halfToFloat(s[i]); });
+        break;
+    }
+
+    case SampleFormat::int16:
+    {
+        auto* s = reinterpret_cast<const juce::int16*>(source);
+        process([s](int i) { return (float)s[i] / int16Scale; });
+        break;
+    }
+
+    case SampleFormat::int24:
+        process([source](int i) { return readInt24(source + i * 3); });
+        break;
+    }
+}
+
+template <typename SampleType>
+void DelayLine::write(int channel, int position, const SampleType* source, int numSamples) noexcept
+{
+    jassert(numSamples <= capacity);
+
+    auto* data = getChannel(channel);
+    position = wrap(position);
+
+    if (mirrored)
+    {
+        writeSpan(data + (size_t)position * (size_t)bytesPerSample, source, numSamples);
+        return;
+    }
+
+    auto numSamplesToEnd = juce::jmin(numSamples, capacity - position);
+    writeSpan(data + (size_t)position * (size_t)bytesPerSample, source, numSamplesToEnd);
+    writeSpan(data, source + numSamplesToEnd, numSamples - numSamplesToEnd);
+}
+
+template <typename SampleType>
+void DelayLine::addTo(SampleType* dest, int channel, int position, int numSamples, float startGain, float endGain) const noexcept
+{
+    jassert(numSamples <= capacity);
+
+    auto* data = getChannel(channel);
+    position = wrap(position);
+
+    auto gain = (SampleType)startGain;
+    auto increment = numSamples > 0 ? (SampleType)(endGain - startGain) / (SampleType)numSamples : (SampleType)0;
+
+    if (mirrored)
+    {
+        addSpan(dest, data + (size_t)position * (size_t)bytesPerSample, numSamples, gain, increment);
+        return;
+    }
+
+    auto numSamplesToEnd = juce::jmin(numSamples, capacity - position);
+    addSpan(dest, data + (size_t)position * (size_t)bytesPerSample, numSamplesToEnd, gain, increment);
+    addSpan(dest + numSamplesToEnd, data, numSamples - numSamplesToEnd, gain + increment * (SampleType)numSamplesToEnd, increment);
+}
+
+//==============================================================================
+template void DelayLine::write<float>(int, int, const float*, int) noexcept;
+template void DelayLine::write<double>(int, int, const double*, int) noexcept;
+template void DelayLine::addTo<float>(float*, int, int, int, float, float) const noexcept;
+template void DelayLine::addTo<double>(double*, int, int, int, float, float) const noexcept;
@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    DelayLine.h
+
+    Multichannel ring buffer with a power-of-two capacity, so positions wrap
+    with a bitmask instead of a modulus.
+
+    On Linux every channel is mapped twice, back to back, onto the same
+    memory (memfd + two mmap views). Any span of up to getCapacity() samples
+    starting anywhere in the ring is then contiguous in memory, and reads and
+    writes never have to be split at the wrap point. Where that isn't
+    available the line falls back to a plain allocation and splits spans
+    in two.
+
+    Samples can be stored as 32-bit float or, to save memory, as 16-bit
+    float or 16/24-bit integers, or as 64-bit float to keep a double
+    precision signal exact. Reads and writes take float or double and
+    convert on the way in and out. The integer formats keep 12 dB of
+    headroom above full scale, so only signals beyond that are clipped.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class DelayLine
+{
+public:
+    enum class SampleFormat
+    {
+        float32,
+        float16,
+        int16,
+        int24,
+        float64
+    };
+
+    static int getBytesPerSample(SampleFormat format) noexcept;
+    static juce::String getFormatName(SampleFormat format);
+    static bool getFormatFromName(const juce::String& name, SampleFormat& format);
+
+    DelayLine() = default;
+    ~DelayLine();
+
+    // Allocates at least minimumCapacity samples per channel, rounded up to
+    // a power of two. Not realtime safe.
+    void setSize(int numChannels, int minimumCapacity, SampleFormat format = SampleFormat::float32, bool tryMirroring = true);
+    void release();
+    void clear();
+
+    int getNumChannels() const noexcept      { return numChannels; }
+    int getCapacity() const noexcept         { return capacity; }
+    int getMask() const noexcept             { return capacity - 1; }
+    bool isMirrored() const noexcept         { return mirrored; }
+    SampleFormat getFormat() const noexcept  { return format; }
+
+    int wrap(int position) const noexcept { return position & (capacity - 1); }
+
+    // Copies numSamples (<= capacity) into the ring starting at position
+    template <typename SampleType>
+    void write(int channel, int position, const SampleType* source, int numSamples) noexcept;
+
+    // Adds numSamples from the ring starting at position to dest, with a
+    // linear gain ramp as in AudioBuffer::addFromWithRamp
+    template <typename SampleType>
+    void addTo(SampleType* dest, int channel, int position, int numSamples, float startGain, float endGain) const noexcept;
+
+    // Bytes of memory backing the line
+    size_t getSizeInBytes() const noexcept { return (size_t)numChannels * (size_t)capacity * (size_t)bytesPerSample; }
+
+private:
+    bool allocateMirrored();
+
+    char* getChannel(int channel) const noexcept { return channels + (size_t)channel * (size_t)stride * (size_t)bytesPerSample; }
+
+    template <typename SampleType>
+    void writeSpan(char* dest, const SampleType* source, int numSamples) const noexcept;
+
+    template <typename SampleType>
+    void addSpan(SampleType* dest, const char* source, int numSamples, SampleType gain, SampleType increment) const noexcept;
+
+    char* channels{ nullptr };
+    int numChannels{ 0 };
+    int capacity{ 0 };
+    int stride{ 0 };
+    int bytesPerSample{ 4 };
+    SampleFormat format{ SampleFormat::float32 };
+    bool mirrored{ false };
+
+    juce::HeapBlock<char> heapMemory;
+    void* mappedMemory{ nullptr };
+    size_t mappedSize{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(DelayLine)
+};
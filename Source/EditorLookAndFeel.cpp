@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    EditorLookAndFeel.cpp
+
+  ==============================================================================
+*/
+
+#include "EditorLookAndFeel.h"
+
+namespace
+{
+    // Relative to the knob's radius
+    constexpr float trackWidth = 0.12f;
+    constexpr float bodyRadius = 0.72f;
+}
+
+void EditorLookAndFeel::drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPosProportional,
+                                         float rotaryStartAngle, float rotaryEndAngle, juce::Slider& slider)
+{
+    auto bounds = juce::Rectangle<int>(x, y, width, height).toFloat().reduced(4.0f);
+    auto diameter = juce::jmin(bounds.getWidth(), bounds.getHeight());
+
+    if (diameter <= 0.0f)
+        return;
+
+    auto faceBounds = bounds.withSizeKeepingCentre(diameter, diameter);
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    auto& face = getKnobFace(juce::roundToInt(diameter * scale),
+                             slider.findColour(juce::Slider::rotarySliderOutlineColourId),
+                             slider.findColour(juce::Slider::backgroundColourId),
+                             rotaryStartAngle, rotaryEndAngle);
+
+    g.drawImage(face, faceBounds);
+
+    // Only the value changes between repaints
+    auto radius = diameter * 0.5f;
+    auto centre = faceBounds.getCentre();
+    auto lineWidth = radius * trackWidth;
+    auto arcRadius = radius - lineWidth * 0.5f;
+    auto angle = rotaryStartAngle + sliderPosProportional * (rotaryEndAngle - rotaryStartAngle);
+
+    juce::Path valueArc;
+    valueArc.addCentredArc(centre.x, centre.y, arcRadius, arcRadius, 0.0f, rotaryStartAngle, angle, true);
+
+    g.setColour(slider.findColour(juce::Slider::rotarySliderFillColourId));
+    g.strokePath(valueArc, juce::PathStrokeType(lineWidth, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
+
+    auto pointerStart = centre.getPointOnCircumference(radius * bodyRadius * 0.3f, angle);
+    auto pointerEnd = centre.getPointOnCircumference(radius * bodyRadius * 0.9f, angle);
+
+    g.setColour(slider.findColour(juce::Slider::thumbColourId));
+    g.drawLine({ pointerStart, pointerEnd }, lineWidth * 0.8f);
+}
+
+const juce::Image& EditorLookAndFeel::getKnobFace(int diameter, juce::Colour outline, juce::Colour body,
+                                                  float rotaryStartAngle, float rotaryEndAngle)
+{
+    auto key = FaceKey{ diameter, outline.getARGB(), body.getARGB() };
+
+    if (auto it = knobFaces.find(key); it != knobFaces.end())
+        return it->second;
+
+    juce::Image face(juce::Image::ARGB, diameter, diameter, true);
+    juce::Graphics g(face);
+
+    auto radius = (float)diameter * 0.5f;
+    auto centre = juce::Point<float>(radius, radius);
+    auto lineWidth = radius * trackWidth;
+    auto arcRadius = radius - lineWidth * 0.5f;
+
+    // Track the value arc is drawn over
+    juce::Path track;
+    track.addCentredArc(centre.x, centre.y, arcRadius, arcRadius, 0.0f, rotaryStartAngle, rotaryEndAngle, true);
+    g.setColour(outline);
+    g.strokePath(track, juce::PathStrokeType(lineWidth, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
+
+    // Body, lit from the top
+    auto bodyBounds = juce::Rectangle<float>(radius * bodyRadius * 2.0f, radius * bodyRadius * 2.0f).withCentre(centre);
+    g.setGradientFill(juce::ColourGradient(body.brighter(0.4f), bodyBounds.getTopLeft(),
+                                           body.darker(0.4f), bodyBounds.getBottomRight(), false));
+    g.fillEllipse(bodyBounds);
+    g.setColour(body.darker(0.8f));
+    g.drawEllipse(bodyBounds, juce::jmax(1.0f, lineWidth * 0.25f));
+
+    // Scale ticks between the track and the body
+    g.setColour(outline.brighter(0.3f));
+
+    for (int i = 0; i <= 10; ++i)
+    {
+        auto angle = rotaryStartAngle + (float)i / 10.0f * (rotaryEndAngle - rotaryStartAngle);
+        auto inner = centre.getPointOnCircumference(radius * (bodyRadius + 0.04f), angle);
+        auto outer = centre.getPointOnCircumference(radius - lineWidth * 1.2f, angle);
+        g.drawLine({ inner, outer }, juce::jmax(1.0f, lineWidth * 0.2f));
+    }
+
+    return knobFaces.emplace(key, face).first->second;
+}
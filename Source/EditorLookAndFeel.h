@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    EditorLookAndFeel.h
+
+    Rotary knobs whose static face (body, shading, scale and track) is drawn
+    once into an image per size and colour. Every repaint after that blits
+    the face and only draws the value arc and the pointer.
+
+    Faces are rendered at the display's physical scale, so they stay sharp
+    on high DPI screens. clearCache() drops them once the editor has been
+    resized, and the new sizes get drawn on their first paint.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class EditorLookAndFeel : public juce::LookAndFeel_V4
+{
+public:
+    void drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPosProportional,
+                          float rotaryStartAngle, float rotaryEndAngle, juce::Slider& slider) override;
+
+    void clearCache() { knobFaces.clear(); }
+
+private:
+    // Diameter in physical pixels, outline colour and body colour
+    using FaceKey = std::tuple<int, juce::uint32, juce::uint32>;
+
+    const juce::Image& getKnobFace(int diameter, juce::Colour outline, juce::Colour body,
+                                   float rotaryStartAngle, float rotaryEndAngle);
+
+    std::map<FaceKey, juce::Image> knobFaces;
+};
@@ -0,0 +1,387 @@
+/*
+  ==============================================================================
+
+    LinearPhaseCrossover.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseCrossover.h"
+
+//==============================================================================
+template <int NumBands>
+class LinearPhaseCrossover<NumBands>::DesignThread : public juce::Thread
+{
+public:
+    explicit DesignThread(LinearPhaseCrossover& c) : juce::Thread("BandSplitDelay FIR design"), crossover(c) {}
+
+    void run() override
+    {
+        // Polls, so the audio thread never has to signal anything
+        while (!threadShouldExit())
+        {
+            crossover.designPendingRequest(designFFT);
+            wait(10);
+        }
+    }
+
+private:
+    LinearPhaseCrossover& crossover;
+    juce::dsp::FFT designFFT{ fftOrder };
+};
+
+//==============================================================================
+template <int NumBands>
+LinearPhaseCrossover<NumBands>::LinearPhaseCrossover()
+{
+    for (auto& frequency : requestedFrequencies)
+        frequency.store(1000.0f);
+}
+
+template <int NumBands>
+LinearPhaseCrossover<NumBands>::~LinearPhaseCrossover()
+{
+    release();
+}
+
+template <int NumBands>
+void LinearPhaseCrossover<NumBands>::prepare(const juce::dsp::ProcessSpec& spec, const std::array<float, numSplits>& frequencies)
+{
+    release();
+
+    // About 85 ms of filter, one short of a power of two so the delay is a
+    // whole number of samples
+    sampleRate = spec.sampleRate;
+    filterLength = juce::nextPowerOfTwo((int)(sampleRate / 12.0)) - 1;
+    numPartitions = (filterLength + partitionSize - 1) / partitionSize;
+
+    for (auto& set : filterSets)
+        set.assign((size_t)(numBands * numPartitions * numBins * 2), 0.0f);
+
+    channels.resize(spec.numChannels);
+
+    for (auto& state : channels)
+    {
+        state.window.assign((size_t)fftSize, 0.0f);
+        state.spectra.assign((size_t)(numPartitions * numBins * 2), 0.0f);
+        state.outputs.assign((size_t)(numBands * partitionSize), 0.0f);
+    }
+
+    fftBuffer.assign((size_t)(fftSize * 2), 0.0f);
+    accumulator.assign((size_t)(numBins * 2), 0.0f);
+    fadeBuffer.assign((size_t)partitionSize, 0.0f);
+
+    // The first filters are ready before any audio
+    design(filterSets[0], frequencies, fft);
+    slots = packSlots(0, noSlot, noSlot);
+
+    lastRequest = frequencies;
+
+    for (size_t k = 0; k < (size_t)numSplits; ++k)
+        requestedFrequencies[k].store(frequencies[k]);
+
+    designedGeneration = requestedGeneration.load();
+    reset();
+
+    designThread = std::make_unique<DesignThread>(*this);
+
+   #if JUCE_VERSION >= 0x70003
+    designThread->startThread(juce::Thread::Priority::background);
+   #else
+    designThread->startThread(2);
+   #endif
+}
+
+template <int NumBands>
+void LinearPhaseCrossover<NumBands>::release()
+{
+    if (designThread != nullptr)
+    {
+        designThread->stopThread(1000);
+        designThread.reset();
+    }
+
+    for (auto& set : filterSets)
+        FilterSet().swap(set);
+
+    channels.clear();
+    numPartitions = 0;
+}
+
+template <int NumBands>
+void LinearPhaseCrossover<NumBands>::reset()
+{
+    for (auto& state : channels)
+    {
+        std::fill(state.window.begin(), state.window.end(), 0.0f);
+        std::fill(state.spectra.begin(), state.spectra.end(), 0.0f);
+        std::fill(state.outputs.begin(), state.outputs.end(), 0.0f);
+    }
+
+    spectrumPosition = 0;
+    fifoPosition = 0;
+}
+
+template <int NumBands>
+size_t LinearPhaseCrossover<NumBands>::getMemoryFootprint() const noexcept
+{
+    size_t numFloats = fftBuffer.size() + accumulator.size() + fadeBuffer.size();
+
+    for (auto& set : filterSets)
+        numFloats += set.size();
+
+    for (auto& state : channels)
+        numFloats += state.window.size() + state.spectra.size() + state.outputs.size();
+
+    return numFloats * sizeof(float);
+}
+
+//==============================================================================
+template <int NumBands>
+void LinearPhaseCrossover<NumBands>::setCrossoverFrequencies(const std::array<float, numSplits>& frequencies) noexcept
+{
+    if (frequencies == lastRequest)
+        return;
+
+    lastRequest = frequencies;
+
+    for (size_t k = 0; k < (size_t)numSplits; ++k)
+        requestedFrequencies[k].store(frequencies[k], std::memory_order_relaxed);
+
+    requestedGeneration.fetch_add(1, std::memory_order_release);
+}
+
+template <int NumBands>
+void LinearPhaseCrossover<NumBands>::designPendingRequest(juce::dsp::FFT& designFFT)
+{
+    auto generation = requestedGeneration.load(std::memory_order_acquire);
+
+    if (generation == designedGeneration)
+        return;
+
+    std::array<float, numSplits> frequencies;
+
+    for (size_t k = 0; k < (size_t)numSplits; ++k)
+        frequencies[k] = requestedFrequencies[k].load(std::memory_order_relaxed);
+
+    // Any slot that is neither active, fading nor pending. Only this thread
+    // makes a free slot pending, so it stays free while it is designed. If
+    // all of them are busy, the next wake up tries again.
+    auto slotWord = slots.load(std::memory_order_acquire);
+    auto slot = noSlot;
+
+    for (juce::uint32 s = 0; s < (juce::uint32)numSlots && slot == noSlot; ++s)
+    {
+        if (s != getActiveSlot(slotWord) && s != getFadingSlot(slotWord) && s != getPendingSlot(slotWord))
+            slot = s;
+    }
+
+    if (slot == noSlot)
+        return;
+
+    design(filterSets[(size_t)slot], frequencies, designFFT);
+    designedGeneration = generation;
+
+    // A pending set the audio thread hasn't taken yet is simply replaced,
+    // and becomes free again
+    while (!slots.compare_exchange_weak(slotWord, (slotWord & ~packSlots(0, 0, noSlot)) | packSlots(0, 0, slot),
+                                        std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+    }
+}
+
+template <int NumBands>
+void LinearPhaseCrossover<NumBands>::design(FilterSet& set, const std::array<float, numSplits>& frequencies,
+                                            juce::dsp::FFT& designFFT) const
+{
+    auto length = (size_t)filterLength;
+    auto centre = (filterLength - 1) / 2;
+
+    std::vector<float> window(length);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), length,
+                                                             juce::dsp::WindowingFunction<float>::blackman, false);
+
+    // Windowed sinc lowpass for every split, unity gain at DC
+    std::vector<float> lowpasses((size_t)numSplits * length);
+
+    for (size_t k = 0; k < (size_t)numSplits; ++k)
+    {
+        auto cutoff = juce::jlimit(1.0, sampleRate * 0.49, (double)frequencies[k]) / sampleRate;
+        auto* h = lowpasses.data() + k * length;
+        auto sum = 0.0;
+
+        for (int n = 0; n < filterLength; ++n)
+        {
+            auto x = (double)(n - centre);
+            auto sinc = n == centre ? 2.0 * cutoff
+                                    : std::sin(juce::MathConstants<double>::twoPi * cutoff * x) / (juce::MathConstants<double>::pi * x);
+
+            h[n] = (float)(sinc * window[(size_t)n]);
+            sum += h[n];
+        }
+
+        for (size_t n = 0; n < length; ++n)
+            h[n] = (float)(h[n] / sum);
+    }
+
+    // Each band is the difference of the lowpasses around it, then every
+    // partition of it is transformed
+    std::vector<float> taps(length);
+    std::vector<float> buffer((size_t)(fftSize * 2));
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        for (size_t n = 0; n < length; ++n)
+        {
+            auto upper = band < numSplits ? lowpasses[(size_t)band * length + n] : (n == (size_t)centre ? 1.0f : 0.0f);
+            auto lower = band > 0 ? lowpasses[(size_t)(band - 1) * length + n] : 0.0f;
+            taps[n] = upper - lower;
+        }
+
+        for (int partition = 0; partition < numPartitions; ++partition)
+        {
+            std::fill(buffer.begin(), buffer.end(), 0.0f);
+
+            auto first = partition * partitionSize;
+            auto count = juce::jmin(partitionSize, filterLength - first);
+            std::copy(taps.begin() + first, taps.begin() + first + count, buffer.begin());
+
+            designFFT.performRealOnlyForwardTransform(buffer.data(), true);
+            std::copy(buffer.begin(), buffer.begin() + numBins * 2, getFilterSpectrum(set, band, partition));
+        }
+    }
+}
+
+//==============================================================================
+template <int NumBands>
+void LinearPhaseCrossover<NumBands>::process(const juce::AudioBuffer<float>& input, BandBuffers& bands) noexcept
+{
+    jassert(isPrepared());
+
+    auto numSamples = input.getNumSamples();
+    auto numChannels = juce::jmin(input.getNumChannels(), (int)channels.size());
+
+    for (int done = 0; done < numSamples;)
+    {
+        auto count = juce::jmin(partitionSize - fifoPosition, numSamples - done);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto& state = channels[(size_t)channel];
+
+            // Input first, it may be the same buffer as a band
+            juce::FloatVectorOperations::copy(state.window.data() + partitionSize + fifoPosition,
+                                              input.getReadPointer(channel, done), count);
+
+            for (int band = 0; band < numBands; ++band)
+            {
+                juce::FloatVectorOperations::copy(bands[(size_t)band].getWritePointer(channel, done),
+                                                  state.outputs.data() + band * partitionSize + fifoPosition, count);
+            }
+        }
+
+        fifoPosition += count;
+        done += count;
+
+        if (fifoPosition == partitionSize)
+        {
+            processPartition(numChannels);
+            fifoPosition = 0;
+        }
+    }
+}
+
+template <int NumBands>
+void LinearPhaseCrossover<NumBands>::processPartition(int numChannels) noexcept
+{
+    // New filters take over here and fade in over this partition. The
+    // design thread may replace the pending set at any moment, so the
+    // whole word is swapped at once.
+    auto slotWord = slots.load(std::memory_order_acquire);
+
+    while (getPendingSlot(slotWord) != noSlot)
+    {
+        auto next = packSlots(getPendingSlot(slotWord), getActiveSlot(slotWord), noSlot);
+
+        if (slots.compare_exchange_weak(slotWord, next, std::memory_order_acq_rel, std::memory_order_acquire))
+            slotWord = next;
+    }
+
+    auto& active = filterSets[(size_t)getActiveSlot(slotWord)];
+    auto fading = getFadingSlot(slotWord);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto& state = channels[(size_t)channel];
+
+        // Spectrum of the last two partitions of input
+        std::copy(state.window.begin(), state.window.end(), fftBuffer.begin());
+        fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+        std::copy(fftBuffer.begin(), fftBuffer.begin() + numBins * 2,
+                  state.spectra.begin() + spectrumPosition * numBins * 2);
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            auto* output = state.outputs.data() + band * partitionSize;
+            convolve(state, active, band, output);
+
+            if (fading != noSlot)
+            {
+                convolve(state, filterSets[(size_t)fading], band, fadeBuffer.data());
+
+                for (int i = 0; i < partitionSize; ++i)
+                {
+                    auto amount = (float)(i + 1) / (float)partitionSize;
+                    output[i] = fadeBuffer[(size_t)i] + (output[i] - fadeBuffer[(size_t)i]) * amount;
+                }
+            }
+        }
+
+        // The current partition becomes the previous one
+        std::copy(state.window.begin() + partitionSize, state.window.end(), state.window.begin());
+    }
+
+    spectrumPosition = (spectrumPosition + 1) % numPartitions;
+
+    // Done reading the old filters, the design thread may reuse their slot
+    if (fading != noSlot)
+        slots.fetch_or(packSlots(0, noSlot, 0), std::memory_order_release);
+}
+
+template <int NumBands>
+void LinearPhaseCrossover<NumBands>::convolve(const ChannelState& state, FilterSet& set, int band, float* output) noexcept
+{
+    auto* sum = accumulator.data();
+    std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+
+    // Newest input spectrum with the first filter partition, and so on back
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        auto position = spectrumPosition - partition;
+        if (position < 0)
+            position += numPartitions;
+
+        auto* x = state.spectra.data() + position * numBins * 2;
+        auto* h = getFilterSpectrum(set, band, partition);
+
+        for (int bin = 0; bin < numBins * 2; bin += 2)
+        {
+            sum[bin]     += x[bin] * h[bin]     - x[bin + 1] * h[bin + 1];
+            sum[bin + 1] += x[bin] * h[bin + 1] + x[bin + 1] * h[bin];
+        }
+    }
+
+    // Overlap-save: only the second half is free of wrap-around
+    std::copy(accumulator.begin(), accumulator.end(), fftBuffer.begin());
+    fft.performRealOnlyInverseTransform(fftBuffer.data());
+    std::copy(fftBuffer.begin() + partitionSize, fftBuffer.begin() + fftSize, output);
+}
+
+//==============================================================================
+template class LinearPhaseCrossover<2>;
+template class LinearPhaseCrossover<3>;
+template class LinearPhaseCrossover<4>;
+template class LinearPhaseCrossover<5>;
+template class LinearPhaseCrossover<6>;
+template class LinearPhaseCrossover<7>;
+template class LinearPhaseCrossover<8>;
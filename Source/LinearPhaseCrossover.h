@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    LinearPhaseCrossover.h
+
+    FIR alternative to BandCrossover for when the bands must not be phase
+    shifted, e.g. in mastering.
+
+    Every split is a Blackman-windowed sinc lowpass of the same length, and
+    the bands are their differences:
+
+        band 0   = LP(f1)
+        band k   = LP(fk+1) - LP(fk)
+        band N-1 = delta - LP(fN-1)
+
+    so they sum back to the input, delayed by half the filter length.
+
+    The filters run as uniformly partitioned overlap-save convolution with
+    juce::dsp::FFT: each input partition is transformed once, and every band
+    multiplies the last few input spectra with its own filter partitions.
+    Samples are collected a partition at a time, which adds one partition
+    of latency on top of the filter's own.
+
+    New crossover frequencies are designed on a background thread into a
+    spare filter slot and handed over through one atomic word that says
+    which slot is active, fading out and pending. The audio thread
+    crossfades from the old filters to the new ones over one partition.
+    Nothing on the audio thread waits, locks or allocates.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+template <int NumBands>
+class LinearPhaseCrossover
+{
+public:
+    static_assert(NumBands >= 2 && NumBands <= 8, "2 to 8 bands are supported");
+
+    static constexpr int numBands = NumBands;
+    static constexpr int numSplits = NumBands - 1;
+
+    using BandBuffers = std::array<juce::AudioBuffer<float>, NumBands>;
+
+    // Samples per partition, and per FFT half
+    static constexpr int partitionSize = 256;
+
+    LinearPhaseCrossover();
+    ~LinearPhaseCrossover();
+
+    // Allocates, designs the first filters and starts the design thread.
+    // Not realtime safe.
+    void prepare(const juce::dsp::ProcessSpec& spec, const std::array<float, numSplits>& frequencies);
+
+    // Stops the design thread and frees the filters
+    void release();
+    void reset();
+
+    bool isPrepared() const noexcept { return numPartitions > 0; }
+
+    // Requests new filters when the frequencies changed, they take over a
+    // few milliseconds later
+    void setCrossoverFrequencies(const std::array<float, numSplits>& frequencies) noexcept;
+
+    // Same contract as BandCrossover::process
+    void process(const juce::AudioBuffer<float>& input, BandBuffers& bands) noexcept;
+
+    // Filter delay plus one partition, in samples
+    int getLatencyInSamples() const noexcept { return filterLength / 2 + partitionSize; }
+
+    size_t getMemoryFootprint() const noexcept;
+
+private:
+    class DesignThread;
+
+    static constexpr int fftOrder = 9;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = partitionSize + 1;
+    static_assert(fftSize == partitionSize * 2, "each FFT covers two partitions");
+
+    // Interleaved complex spectra of every partition of every band
+    static constexpr int numSlots = 4;
+    using FilterSet = std::vector<float>;
+
+    float* getFilterSpectrum(FilterSet& set, int band, int partition) const noexcept
+    {
+        return set.data() + ((size_t)band * (size_t)numPartitions + (size_t)partition) * (size_t)(numBins * 2);
+    }
+
+    void design(FilterSet& set, const std::array<float, numSplits>& frequencies, juce::dsp::FFT& designFFT) const;
+    void designPendingRequest(juce::dsp::FFT& designFFT);
+
+    struct ChannelState
+    {
+        // Previous and current partition of input, the input spectra of
+        // the last numPartitions partitions, and a partition of every band
+        std::vector<float> window;
+        std::vector<float> spectra;
+        std::vector<float> outputs;
+    };
+
+    void processPartition(int numChannels) noexcept;
+    void convolve(const ChannelState& state, FilterSet& set, int band, float* output) noexcept;
+
+    double sampleRate{ 44100.0 };
+    int filterLength{ 0 };
+    int numPartitions{ 0 };
+
+    // Slots are either active, fading out, pending or free. The three used
+    // ones are packed into one word, four bits each, and both threads change
+    // it with a compare and swap, so the design thread never sees a slot as
+    // free while the audio thread is moving it from pending to active. Only
+    // the audio thread changes active and fading, and only the design
+    // thread sets pending and writes into the free slots.
+    static constexpr juce::uint32 noSlot = 0xf;
+    static_assert(numSlots < (int)noSlot, "slot indices need four bits");
+
+    static constexpr juce::uint32 packSlots(juce::uint32 active, juce::uint32 fading, juce::uint32 pending) noexcept
+    {
+        return active | (fading << 4) | (pending << 8);
+    }
+
+    static constexpr juce::uint32 getActiveSlot(juce::uint32 slots) noexcept  { return slots & 0xf; }
+    static constexpr juce::uint32 getFadingSlot(juce::uint32 slots) noexcept  { return (slots >> 4) & 0xf; }
+    static constexpr juce::uint32 getPendingSlot(juce::uint32 slots) noexcept { return (slots >> 8) & 0xf; }
+
+    std::array<FilterSet, numSlots> filterSets;
+    std::atomic<juce::uint32> slots{ packSlots(0, noSlot, noSlot) };
+
+    // Requests from the audio thread, picked up by the design thread
+    std::array<std::atomic<float>, numSplits> requestedFrequencies;
+    std::atomic<juce::uint32> requestedGeneration{ 0 };
+    juce::uint32 designedGeneration{ 0 };
+    std::array<float, numSplits> lastRequest{};
+
+    std::vector<ChannelState> channels;
+    int spectrumPosition{ 0 };
+    int fifoPosition{ 0 };
+
+    juce::dsp::FFT fft{ fftOrder };
+    std::vector<float> fftBuffer, accumulator, fadeBuffer;
+
+    std::unique_ptr<DesignThread> designThread;
+};
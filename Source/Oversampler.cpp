@@ -0,0 +1,361 @@
+/*
+  ==============================================================================
+
+    Oversampler.cpp
+
+  ==============================================================================
+*/
+
+#include "Oversampler.h"
+
+//==============================================================================
+// One 2x stage with both designs, up and down state per channel
+class Oversampler::Stage
+{
+public:
+    // Transition width relative to the higher rate, attenuation in dB
+    Stage(double transitionWidth, double attenuation)
+    {
+        designLinearPhase(transitionWidth, attenuation);
+        designMinimumPhase(transitionWidth, attenuation);
+    }
+
+    // maxSamples counts samples at the lower rate
+    void prepare(int numChannels, int maxSamples)
+    {
+        auto numOddHistory = (centre + 1) / 2;
+
+        channels.resize((size_t)numChannels);
+
+        for (auto& state : channels)
+        {
+            state.upHistory.resize((size_t)centre);
+            state.evenHistory.resize((size_t)centre);
+            state.oddHistory.resize((size_t)numOddHistory);
+            state.upDirect.resize(directAlphas.size());
+            state.upDelayed.resize(delayedAlphas.size());
+            state.downDirect.resize(directAlphas.size());
+            state.downDelayed.resize(delayedAlphas.size());
+        }
+
+        work.resize((size_t)(centre + maxSamples));
+        oddWork.resize((size_t)(numOddHistory + maxSamples));
+        pairs.resize((size_t)chunkSize);
+        sums.resize((size_t)chunkSize);
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& state : channels)
+        {
+            for (auto* values : { &state.upHistory, &state.evenHistory, &state.oddHistory,
+                                  &state.upDirect, &state.upDelayed, &state.downDirect, &state.downDelayed })
+                std::fill(values->begin(), values->end(), 0.0f);
+
+            state.downPrevious = 0.0f;
+        }
+    }
+
+    // Up and back down again, in samples at the lower rate
+    double getLatency(Phase phase) const noexcept
+    {
+        if (phase == Phase::linear)
+            return (double)centre;
+
+        // Each allpass delays DC by (1 - a) / (1 + a) samples at the lower
+        // rate, the two paths are half a sample apart at the higher rate
+        auto latency = 0.5;
+
+        for (auto* alphas : { &directAlphas, &delayedAlphas })
+            for (auto alpha : *alphas)
+                latency += (1.0 - alpha) / (1.0 + alpha);
+
+        return latency;
+    }
+
+    // numSamples in, numSamples * 2 out
+    void up(Phase phase, int channel, const float* input, float* output, int numSamples) noexcept
+    {
+        auto& state = channels[(size_t)channel];
+
+        if (phase == Phase::minimum)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                output[i * 2]     = allpassChain(input[i], directAlphas, state.upDirect);
+                output[i * 2 + 1] = allpassChain(input[i], delayedAlphas, state.upDelayed);
+            }
+
+            return;
+        }
+
+        // History and block side by side, so every tap reads contiguous memory
+        auto* w = work.data();
+        std::copy(state.upHistory.begin(), state.upHistory.end(), w);
+        std::copy(input, input + numSamples, w + centre);
+
+        auto oddOffset = (centre + 1) / 2;
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            auto count = juce::jmin(chunkSize, numSamples - start);
+            auto* x = w + start;
+
+            juce::FloatVectorOperations::clear(sums.data(), count);
+            addTaps(x, sums.data(), count);
+
+            // Zero stuffing halves the level, the taps are doubled to make up
+            for (int i = 0; i < count; ++i)
+            {
+                output[(start + i) * 2]     = 2.0f * sums[(size_t)i];
+                output[(start + i) * 2 + 1] = 2.0f * centreTap * x[i + oddOffset];
+            }
+        }
+
+        std::copy(w + numSamples, w + numSamples + centre, state.upHistory.begin());
+    }
+
+    // numSamples * 2 in, numSamples out
+    void down(Phase phase, int channel, const float* input, float* output, int numSamples) noexcept
+    {
+        auto& state = channels[(size_t)channel];
+
+        if (phase == Phase::minimum)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto direct = allpassChain(input[i * 2], directAlphas, state.downDirect);
+                output[i] = 0.5f * (direct + state.downPrevious);
+                state.downPrevious = allpassChain(input[i * 2 + 1], delayedAlphas, state.downDelayed);
+            }
+
+            return;
+        }
+
+        // Even and odd samples each behind their history
+        auto numOddHistory = (int)state.oddHistory.size();
+        auto* even = work.data();
+        auto* odd = oddWork.data();
+
+        std::copy(state.evenHistory.begin(), state.evenHistory.end(), even);
+        std::copy(state.oddHistory.begin(), state.oddHistory.end(), odd);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            even[centre + i] = input[i * 2];
+            odd[numOddHistory + i] = input[i * 2 + 1];
+        }
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            auto count = juce::jmin(chunkSize, numSamples - start);
+
+            juce::FloatVectorOperations::copyWithMultiply(output + start, odd + start, centreTap, count);
+            addTaps(even + start, output + start, count);
+        }
+
+        std::copy(even + numSamples, even + numSamples + centre, state.evenHistory.begin());
+        std::copy(odd + numSamples, odd + numSamples + numOddHistory, state.oddHistory.begin());
+    }
+
+private:
+    void designLinearPhase(double transitionWidth, double attenuation)
+    {
+        // Kaiser's estimate of the length, rounded so the centre tap is odd
+        // and the even taps are the ones that aren't zero
+        auto length = (attenuation - 8.0) / (2.285 * juce::MathConstants<double>::twoPi * transitionWidth);
+        centre = (int)std::ceil(length * 0.5) | 1;
+
+        auto numCoefficients = (size_t)(2 * centre + 1);
+        std::vector<float> window(numCoefficients);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), numCoefficients,
+                                                                 juce::dsp::WindowingFunction<float>::kaiser,
+                                                                 false, (float)(0.1102 * (attenuation - 8.7)));
+
+        // h[j] = sinc((j - centre) / 2) / 2, only the first half is kept
+        taps.resize((size_t)((centre + 1) / 2));
+
+        for (size_t k = 0; k < taps.size(); ++k)
+        {
+            auto x = juce::MathConstants<double>::pi * ((double)(2 * k) - centre) * 0.5;
+            taps[k] = (float)(0.5 * std::sin(x) / x * window[2 * k]);
+        }
+
+        centreTap = 0.5f * window[(size_t)centre];
+
+        // Unity gain at DC
+        auto sum = centreTap;
+
+        for (auto tap : taps)
+            sum += 2.0f * tap;
+
+        for (auto& tap : taps)
+            tap /= sum;
+
+        centreTap /= sum;
+    }
+
+    void designMinimumPhase(double transitionWidth, double attenuation)
+    {
+        auto structure = juce::dsp::FilterDesign<float>::designIIRLowpassHalfBandPolyphaseAllpassMethod((float)transitionWidth,
+                                                                                                       (float)-attenuation);
+
+        for (int i = 0; i < structure.directPath.size(); ++i)
+            directAlphas.push_back(structure.directPath[i]->coefficients[0]);
+
+        // The first section of the delayed path is the delay itself
+        for (int i = 1; i < structure.delayedPath.size(); ++i)
+            delayedAlphas.push_back(structure.delayedPath[i]->coefficients[0]);
+    }
+
+    // output[i] += sum of taps[k] * (x[centre + i - k] + x[i + k]) for count
+    // <= chunkSize outputs. The loops run over the outputs, one per SIMD
+    // lane, and each output still adds its taps in order, so nothing is
+    // reassociated and the SIMD kernels give the scalar result.
+    void addTaps(const float* x, float* output, int count) noexcept
+    {
+        for (size_t k = 0; k < taps.size(); ++k)
+        {
+            juce::FloatVectorOperations::add(pairs.data(), x + centre - (int)k, x + k, count);
+            juce::FloatVectorOperations::addWithMultiply(output, pairs.data(), taps[k], count);
+        }
+    }
+
+    // First order allpass sections (a + z^-1) / (1 + a z^-1) in series.
+    // Each output feeds the next, so these stay scalar.
+    static float allpassChain(float x, const std::vector<float>& alphas, std::vector<float>& states) noexcept
+    {
+        for (size_t n = 0; n < alphas.size(); ++n)
+        {
+            auto y = alphas[n] * x + states[n];
+            states[n] = x - alphas[n] * y;
+            x = y;
+        }
+
+        return x;
+    }
+
+    // Linear phase: 2 * centre + 1 taps, of which taps holds h[0], h[2], ...
+    // up to the middle; the odd phase is only the centre tap
+    std::vector<float> taps;
+    float centreTap{ 0.5f };
+    int centre{ 1 };
+
+    // Minimum phase
+    std::vector<float> directAlphas, delayedAlphas;
+
+    struct ChannelState
+    {
+        std::vector<float> upHistory, evenHistory, oddHistory;
+        std::vector<float> upDirect, upDelayed, downDirect, downDelayed;
+        float downPrevious{ 0.0f };
+    };
+
+    std::vector<ChannelState> channels;
+    std::vector<float> work, oddWork;
+
+    // Outputs per addTaps call, small enough for the scratch to stay in L1
+    static constexpr int chunkSize = 256;
+    std::vector<float> pairs, sums;
+};
+
+//==============================================================================
+// The first stage carries the audible band up to 0.45 of the base rate, the
+// second only has to reject images an octave further up
+Oversampler::Oversampler()
+    : stages{ std::make_unique<Stage>(0.05, 90.0), std::make_unique<Stage>(0.2, 90.0) }
+{
+}
+
+Oversampler::~Oversampler() = default;
+
+void Oversampler::prepare(int numChannels, int maxBlockSize)
+{
+    stages[0]->prepare(numChannels, maxBlockSize);
+    stages[1]->prepare(numChannels, maxBlockSize * 2);
+    intermediate.setSize(numChannels, maxBlockSize * 2);
+}
+
+void Oversampler::reset()
+{
+    for (auto& stage : stages)
+        stage->reset();
+}
+
+void Oversampler::setFactor(int newFactor)
+{
+    jassert(newFactor == 1 || newFactor == 2 || newFactor == 4);
+
+    if (newFactor != factor)
+    {
+        factor = newFactor;
+        reset();
+    }
+}
+
+void Oversampler::setPhase(Phase newPhase)
+{
+    if (newPhase != phase)
+    {
+        phase = newPhase;
+        reset();
+    }
+}
+
+float Oversampler::getLatencyInSamples() const noexcept
+{
+    // The second stage runs at twice the base rate
+    auto latency = 0.0;
+
+    for (int i = 0; i < getNumStages(); ++i)
+        latency += stages[(size_t)i]->getLatency(phase) / (double)(1 << i);
+
+    return (float)latency;
+}
+
+void Oversampler::processUp(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output, int numSamples) noexcept
+{
+    jassert(factor > 1);
+    jassert(output.getNumSamples() >= numSamples * factor);
+
+    for (int channel = 0; channel < input.getNumChannels(); ++channel)
+    {
+        auto* in = input.getReadPointer(channel);
+        auto* out = output.getWritePointer(channel);
+
+        if (factor == 2)
+        {
+            stages[0]->up(phase, channel, in, out, numSamples);
+        }
+        else
+        {
+            auto* twice = intermediate.getWritePointer(channel);
+            stages[0]->up(phase, channel, in, twice, numSamples);
+            stages[1]->up(phase, channel, twice, out, numSamples * 2);
+        }
+    }
+}
+
+void Oversampler::processDown(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output, int numSamples) noexcept
+{
+    jassert(factor > 1);
+    jassert(input.getNumSamples() >= numSamples * factor);
+
+    for (int channel = 0; channel < output.getNumChannels(); ++channel)
+    {
+        auto* in = input.getReadPointer(channel);
+        auto* out = output.getWritePointer(channel);
+
+        if (factor == 2)
+        {
+            stages[0]->down(phase, channel, in, out, numSamples);
+        }
+        else
+        {
+            auto* twice = intermediate.getWritePointer(channel);
+            stages[1]->down(phase, channel, in, twice, numSamples * 2);
+            stages[0]->down(phase, channel, twice, out, numSamples);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    Oversampler.h
+
+    2x / 4x resampling with cascaded polyphase half-band filters, one 2x
+    stage per octave. The crossover runs at the higher rate, so its
+    response near 20 kHz isn't squeezed against Nyquist.
+
+    Each stage has two designs:
+
+    - linear phase: a Kaiser-windowed half-band FIR. Every other tap is
+      zero, so each output phase only runs the nonzero taps, folded in
+      symmetric pairs. Each tap is applied to a chunk of outputs at a time
+      with FloatVectorOperations, so the SIMD lanes hold different outputs.
+    - minimum phase: JUCE's polyphase allpass half-band IIR, a fraction of
+      the latency at the cost of some phase shift near the top. Its
+      allpass chains are recursive and run scalar.
+
+    Both designs of both stages are built in prepare(). Switching the factor
+    or the phase afterwards only picks which ones run, nothing is allocated.
+    Every instance keeps its own filter state, so one instance upsamples
+    the input and one per band downsamples that band.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class Oversampler
+{
+public:
+    enum class Phase
+    {
+        minimum,
+        linear
+    };
+
+    static constexpr int maxFactor = 4;
+
+    Oversampler();
+    ~Oversampler();
+
+    // Allocates both designs for up to maxFactor, not realtime safe
+    void prepare(int numChannels, int maxBlockSize);
+    void reset();
+
+    // 1, 2 or 4. Changing either clears the filter state.
+    void setFactor(int newFactor);
+    void setPhase(Phase newPhase);
+
+    int getFactor() const noexcept { return factor; }
+    Phase getPhase() const noexcept { return phase; }
+
+    // Delay of going up and back down again at the current settings, in
+    // samples at the base rate
+    float getLatencyInSamples() const noexcept;
+
+    // Writes numSamples * factor samples of every channel to output
+    void processUp(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output, int numSamples) noexcept;
+
+    // Reads numSamples * factor samples of every channel from input
+    void processDown(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output, int numSamples) noexcept;
+
+private:
+    class Stage;
+
+    int getNumStages() const noexcept { return factor == 4 ? 2 : (factor == 2 ? 1 : 0); }
+
+    std::array<std::unique_ptr<Stage>, 2> stages;
+
+    // Between the 2x and 4x stages
+    juce::AudioBuffer<float> intermediate;
+
+    int factor{ 1 };
+    Phase phase{ Phase::minimum };
+};
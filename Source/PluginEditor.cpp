@@ -10,202 +10,384 @@
 #include "PluginEditor.h"
 
 using namespace Params;
-const auto& params = GetParams();
+
+static std::vector<juce::RangedAudioParameter*> getCrossoverParameters(juce::AudioProcessorValueTreeState& apvts)
+{
+    std::vector<juce::RangedAudioParameter*> parameters;
+
+    for (int i = 0; i < numBands - 1; ++i)
+        parameters.push_back(apvts.getParameter(getCrossoverName(i)));
+
+    return parameters;
+}
+
+//==============================================================================
+void LevelMeter::setLevel(float newPeak, float newRms)
+{
+    // Below the scale is silence, so a falling meter stops repainting
+    auto floor = juce::Decibels::decibelsToGain(minimumDecibels);
+    newPeak = newPeak < floor ? 0.0f : newPeak;
+    newRms = newRms < floor ? 0.0f : newRms;
+
+    if (newPeak != peak || newRms != rms)
+    {
+        peak = newPeak;
+        rms = newRms;
+        repaint();
+    }
+}
+
+void LevelMeter::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+    auto horizontal = bounds.getWidth() > bounds.getHeight();
+
+    g.setColour(juce::Colours::black);
+    g.fillRect(bounds);
+
+    auto toProportion = [](float gain) {
+        return juce::jlimit(0.0f, 1.0f, 1.0f - juce::Decibels::gainToDecibels(gain, minimumDecibels) / minimumDecibels);
+    };
+
+    auto rmsBounds = bounds;
+    auto peakBounds = bounds;
+
+    if (horizontal)
+    {
+        rmsBounds = rmsBounds.removeFromLeft(bounds.getWidth() * toProportion(rms));
+        peakBounds = peakBounds.withX(bounds.getX() + bounds.getWidth() * toProportion(peak) - 1.0f).withWidth(2.0f);
+    }
+    else
+    {
+        rmsBounds = rmsBounds.removeFromBottom(bounds.getHeight() * toProportion(rms));
+        peakBounds = peakBounds.withY(bounds.getBottom() - bounds.getHeight() * toProportion(peak) - 1.0f).withHeight(2.0f);
+    }
+
+    g.setColour(juce::Colours::limegreen);
+    g.fillRect(rmsBounds);
+
+    if (peak > 0.0f)
+    {
+        g.setColour(peak >= 1.0f ? juce::Colours::red : juce::Colours::white);
+        g.fillRect(peakBounds.getIntersection(bounds));
+    }
+}
 
 
 //==============================================================================
 BandSplitDelayAudioProcessorEditor::BandSplitDelayAudioProcessorEditor(BandSplitDelayAudioProcessor& p)
     : AudioProcessorEditor(&p), audioProcessor(p),
-    lowDrySliderAttachment(audioProcessor.apvts, params.at(Names::Low_Dry), lowDrySlider),
-    lowWetSliderAttachment(audioProcessor.apvts, params.at(Names::Low_Wet), lowWetSlider),
-    midDrySliderAttachment(audioProcessor.apvts, params.at(Names::Mid_Dry), midDrySlider),
-    midWetSliderAttachment(audioProcessor.apvts, params.at(Names::Mid_Wet), midWetSlider),
-    highDrySliderAttachment(audioProcessor.apvts, params.at(Names::High_Dry), highDrySlider),
-    highWetSliderAttachment(audioProcessor.apvts, params.at(Names::High_Wet), highWetSlider),
-    lowMidCrosSliderAttachment(audioProcessor.apvts, params.at(Names::Low_Mid_Crossover), lowMidCrosSlider),
-    midHighCrosSliderAttachment(audioProcessor.apvts, params.at(Names::Mid_High_Crossover), midHighCrosSlider)
+      spectrumDisplay(p.getAnalyzer(), getCrossoverParameters(p.apvts), maxFrameRate)
 {
+    setLookAndFeel(&lookAndFeel);
+    setOpaque(true);
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
 
+    for (int band = 0; band < numBands; ++band)
+    {
+        auto& controls = bandControls[(size_t)band];
 
-    for (auto* component : getComps()) {
-        addAndMakeVisible(component);
+        controls.dryAttachment = std::make_unique<Attachment>(audioProcessor.apvts, getBandParamName(band, BandParam::Dry), controls.drySlider);
+        controls.wetAttachment = std::make_unique<Attachment>(audioProcessor.apvts, getBandParamName(band, BandParam::Wet), controls.wetSlider);
+
+        controls.drySlider.setColour(juce::Slider::thumbColourId, juce::Colours::lightblue);
+        controls.wetSlider.setColour(juce::Slider::thumbColourId, juce::Colours::yellow);
+
+        controls.nameLabel.setText(getBandName(band).toUpperCase(), juce::dontSendNotification);
+        controls.dryLabel.setText("DRY", juce::dontSendNotification);
+        controls.wetLabel.setText("WET", juce::dontSendNotification);
     }
 
-    lowDrySlider.setColour(juce::Slider::thumbColourId, juce::Colours::lightblue);
-    midDrySlider.setColour(juce::Slider::thumbColourId, juce::Colours::lightblue);
-    highDrySlider.setColour(juce::Slider::thumbColourId, juce::Colours::lightblue);
-    lowWetSlider.setColour(juce::Slider::thumbColourId, juce::Colours::yellow);
-    midWetSlider.setColour(juce::Slider::thumbColourId, juce::Colours::yellow);
-    highWetSlider.setColour(juce::Slider::thumbColourId, juce::Colours::yellow);
+    for (int i = 0; i < numBands - 1; ++i)
+    {
+        auto& controls = crossoverControls[(size_t)i];
+
+        controls.attachment = std::make_unique<Attachment>(audioProcessor.apvts, getCrossoverName(i), controls.slider);
+        controls.label.setText(getBandName(i) + "->" + getBandName(i + 1) + " \n Crossover", juce::dontSendNotification);
+        controls.label.attachToComponent(&controls.slider, false);
+    }
 
-    lowLabel.setText("LOW", juce::dontSendNotification);
-    midLabel.setText("MID", juce::dontSendNotification);
-    highLabel.setText("HIGH", juce::dontSendNotification);
+    feedbackLabel.setText("FEEDBACK", juce::dontSendNotification);
 
-    lowMidCrosLabel.setText("Low->Mid \n Crossover", juce::dontSendNotification);
-    midHighCrosLabel.setText("Mid->High \n Crossover", juce::dontSendNotification);
-    
-    lowMidCrosLabel.attachToComponent(&lowMidCrosSlider, false);
-    midHighCrosLabel.attachToComponent(&midHighCrosSlider, false);
+    for (int slot = 0; slot < BandSplitDelayAudioProcessor::numMorphSlots; ++slot)
+    {
+        auto& button = morphStoreButtons[(size_t)slot];
+        button.setButtonText("Store " + juce::String::charToString((juce::juce_wchar)('A' + slot)));
+        button.setTooltip("Stores the current settings, shift-click recalls them");
+
+        button.onClick = [this, slot] {
+            if (juce::ModifierKeys::currentModifiers.isShiftDown())
+                audioProcessor.recallMorphSnapshot(slot);
+            else
+                audioProcessor.storeMorphSnapshot(slot);
+        };
+    }
 
-    lowDryLabel.setText("DRY", juce::dontSendNotification);
-    midDryLabel.setText("DRY", juce::dontSendNotification);
-    highDryLabel.setText("DRY", juce::dontSendNotification);
-    lowWetLabel.setText("WET", juce::dontSendNotification);
-    midWetLabel.setText("WET", juce::dontSendNotification);
-    highWetLabel.setText("WET", juce::dontSendNotification);
+    morphAttachment = std::make_unique<Attachment>(audioProcessor.apvts, getParamID(Names::Morph), morphSlider);
+    morphToggleAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        audioProcessor.apvts, getParamID(Names::Morph_Enabled), morphToggle);
 
+    for (auto* component : getComps()) {
+        addAndMakeVisible(component);
+    }
+
+    // Labels never change, each one is kept as an image
     for (auto* label : getLabels()) {
         label->setJustificationType(juce::Justification::centred);
+        label->setBufferedToImage(true);
     }
     
-    setSize(600, 500);
-    setResizable(false, false);
-    isResizable();
+    setResizable(true, true);
+    setResizeLimits(minWidth, minHeight, maxWidth, maxHeight);
+    setSize(defaultWidth, defaultHeight);
+
+    audioProcessor.getMeters().setActive(true);
+    startTimerHz(maxFrameRate);
 }
 
 BandSplitDelayAudioProcessorEditor::~BandSplitDelayAudioProcessorEditor()
 {
+    audioProcessor.getMeters().setActive(false);
+    setLookAndFeel(nullptr);
+}
+
+void BandSplitDelayAudioProcessorEditor::timerCallback()
+{
+    // Every meter falls first, anything louder that arrived since takes over
+    auto decay = std::pow(meterDecayPerSecond, 1.0f / (float)maxFrameRate);
+
+    std::array<float, numBands> dryPeaks, dryRms, wetPeaks, wetRms;
+
+    for (size_t band = 0; band < (size_t)numBands; ++band)
+    {
+        dryPeaks[band] = dryMeters[band].peak * decay;
+        dryRms[band] = dryMeters[band].rms * decay;
+        wetPeaks[band] = wetMeters[band].peak * decay;
+        wetRms[band] = wetMeters[band].rms * decay;
+    }
+
+    auto feedbackPeak = feedbackMeter.peak * decay;
+    auto feedbackRms = feedbackMeter.rms * decay;
+
+    BandSplitDelayAudioProcessor::Meters::Frame frame;
+
+    while (audioProcessor.getMeters().pop(frame))
+    {
+        for (size_t band = 0; band < (size_t)numBands; ++band)
+        {
+            dryPeaks[band] = juce::jmax(dryPeaks[band], frame.dry[band].peak);
+            dryRms[band] = juce::jmax(dryRms[band], frame.dry[band].rms);
+            wetPeaks[band] = juce::jmax(wetPeaks[band], frame.wet[band].peak);
+            wetRms[band] = juce::jmax(wetRms[band], frame.wet[band].rms);
+        }
+
+        feedbackPeak = juce::jmax(feedbackPeak, frame.feedback.peak);
+        feedbackRms = juce::jmax(feedbackRms, frame.feedback.rms);
+    }
+
+    for (size_t band = 0; band < (size_t)numBands; ++band)
+    {
+        dryMeters[band].setLevel(dryPeaks[band], dryRms[band]);
+        wetMeters[band].setLevel(wetPeaks[band], wetRms[band]);
+    }
+
+    feedbackMeter.setLevel(feedbackPeak, feedbackRms);
 }
 
 //==============================================================================
 void BandSplitDelayAudioProcessorEditor::paint (juce::Graphics& g)
 {
+   #if BSD_PAINT_TIMING
+    paintStartTicks = juce::Time::getHighResolutionTicks();
+   #endif
+
+    // Rebuilt lazily, after a resize or when moved to a screen with another scale
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
 
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+    if (!backgroundCache.isValid() || scale != backgroundScale)
+        renderBackground(scale);
 
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
+    g.drawImage(backgroundCache, getLocalBounds().toFloat());
 }
 
-void BandSplitDelayAudioProcessorEditor::resized()
+void BandSplitDelayAudioProcessorEditor::renderBackground(float scale)
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
-    
+    backgroundScale = scale;
+    backgroundCache = juce::Image(juce::Image::RGB, juce::jmax(1, juce::roundToInt((float)getWidth() * scale)),
+                                  juce::jmax(1, juce::roundToInt((float)getHeight() * scale)), false);
 
-    auto bounds = getLocalBounds();
-    auto width = bounds.getWidth();
-    auto height = bounds.getHeight();
+    juce::Graphics g(backgroundCache);
+    g.addTransform(juce::AffineTransform::scale(scale));
 
-    auto labelArea = bounds.removeFromTop(bounds.getHeight() * 0.1);
+    auto background = getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId);
+    g.setGradientFill(juce::ColourGradient(background.brighter(0.15f), 0.0f, 0.0f,
+                                           background.darker(0.3f), 0.0f, (float)getHeight(), false));
+    g.fillAll();
 
-    auto bandLabelsArea = labelArea.removeFromTop(labelArea.getHeight() * 0.75);
+    for (size_t band = 0; band < columnAreas.size(); ++band)
+    {
+        g.setColour(juce::Colours::white.withAlpha(band % 2 == 0 ? 0.06f : 0.03f));
+        g.fillRoundedRectangle(columnAreas[band].toFloat(), 6.0f);
+    }
 
-    auto lowLabelArea = bandLabelsArea.removeFromLeft(bandLabelsArea.getWidth() * 0.33);
-    auto midLabelArea = bandLabelsArea.removeFromLeft(bandLabelsArea.getWidth() * 0.5);
-    auto highLabelArea = bandLabelsArea;
+    g.setColour(juce::Colours::black.withAlpha(0.25f));
+    g.fillRoundedRectangle(meterPanel.toFloat(), 6.0f);
+}
 
-    lowLabel.setBounds(lowLabelArea);
-    midLabel.setBounds(midLabelArea);
-    highLabel.setBounds(highLabelArea);
+#if BSD_PAINT_TIMING
+void BandSplitDelayAudioProcessorEditor::paintOverChildren(juce::Graphics& g)
+{
+    auto milliseconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - paintStartTicks) * 1000.0;
+    averagePaintMilliseconds += 0.1 * (milliseconds - averagePaintMilliseconds);
+    maxPaintMilliseconds = juce::jmax(maxPaintMilliseconds, milliseconds);
+
+    g.setColour(juce::Colours::white);
+    g.setFont(12.0f);
+    g.drawText("paint " + juce::String(averagePaintMilliseconds, 2) + " ms, max " + juce::String(maxPaintMilliseconds, 2) + " ms",
+               getLocalBounds().removeFromTop(14).reduced(4, 0), juce::Justification::topLeft);
+}
+#endif
 
-    auto lowDryLabelArea = labelArea.removeFromLeft(labelArea.getWidth() * 0.33);
-    auto midDryLabelArea = labelArea.removeFromLeft(labelArea.getWidth() * 0.5);
-    auto highDryLabelArea = labelArea;
+void BandSplitDelayAudioProcessorEditor::resized()
+{
+    auto bounds = getLocalBounds();
+    auto width = bounds.getWidth();
+    auto height = bounds.getHeight();
 
-    auto lowWetLabelArea = lowDryLabelArea.removeFromRight(lowDryLabelArea.getWidth() * 0.5);
-    auto midWetLabelArea = midDryLabelArea.removeFromRight(midDryLabelArea.getWidth() * 0.5);
-    auto highWetLabelArea = highDryLabelArea.removeFromRight(highDryLabelArea.getWidth() * 0.5);
+    // Everything cached for the old size is drawn again on the next paint
+    backgroundCache = {};
+    lookAndFeel.clearCache();
 
-    lowDryLabel.setBounds(lowDryLabelArea);
-    midDryLabel.setBounds(midDryLabelArea);
-    highDryLabel.setBounds(highDryLabelArea);
-    
-    lowWetLabel.setBounds(lowWetLabelArea);
-    midWetLabel.setBounds(midWetLabelArea);
-    highWetLabel.setBounds(highWetLabelArea);
+    auto labelArea = bounds.removeFromTop(bounds.getHeight() * 0.1);
+    auto bandLabelsArea = labelArea.removeFromTop(labelArea.getHeight() * 0.75);
 
+    // Dry and wet knobs along the top, one column per band
+    auto sliderArea = bounds.removeFromTop(bounds.getHeight() * 0.25);
+    auto columnWidth = width / numBands;
 
+    for (int band = 0; band < numBands; ++band)
+        columnAreas[(size_t)band] = juce::Rectangle<int>(columnWidth * band, 0, columnWidth, sliderArea.getBottom()).reduced(3);
 
-    auto wetDryArea = bounds.removeFromBottom(bounds.getHeight() * 0.75);
+    for (int band = 0; band < numBands; ++band)
+    {
+        auto& controls = bandControls[(size_t)band];
 
-    auto lowDryArea = bounds.removeFromLeft(bounds.getWidth() * 0.33);
-    auto midDryArea = bounds.removeFromLeft(bounds.getWidth() * 0.5);
-    auto highDryArea = bounds;
+        controls.nameLabel.setBounds(bandLabelsArea.removeFromLeft(columnWidth));
 
-    auto lowWetArea = lowDryArea.removeFromRight(lowDryArea.getWidth() * 0.5);
-    auto midWetArea = midDryArea.removeFromRight(midDryArea.getWidth() * 0.5);
-    auto highWetArea = highDryArea.removeFromRight(highDryArea.getWidth() * 0.5);
+        auto dryLabelArea = labelArea.removeFromLeft(columnWidth);
+        auto wetLabelArea = dryLabelArea.removeFromRight(dryLabelArea.getWidth() / 2);
+        controls.dryLabel.setBounds(dryLabelArea);
+        controls.wetLabel.setBounds(wetLabelArea);
 
-    lowDrySlider.setBounds(lowDryArea);
-    midDrySlider.setBounds(midDryArea);
-    highDrySlider.setBounds(highDryArea);
-    lowWetSlider.setBounds(lowWetArea);
-    midWetSlider.setBounds(midWetArea);
-    highWetSlider.setBounds(highWetArea);
+        auto dryArea = sliderArea.removeFromLeft(columnWidth);
+        auto wetArea = dryArea.removeFromRight(dryArea.getWidth() / 2);
+        controls.drySlider.setBounds(dryArea);
+        controls.wetSlider.setBounds(wetArea);
+    }
 
+    // Meters along the bottom, under each column's knobs
+    auto meterArea = getLocalBounds().removeFromBottom(height / 5).reduced(10);
+    meterPanel = meterArea.expanded(5);
+    auto feedbackArea = meterArea.removeFromBottom(16);
+    meterArea.removeFromBottom(6);
 
-    lowMidCrosSlider.setBounds(width * 0.33 - 75, height * 0.6 - 75, 150, 150);
-    midHighCrosSlider.setBounds(width * 0.66 - 75, height * 0.6 - 75, 150, 150);
+    feedbackLabel.setBounds(feedbackArea.removeFromLeft(80));
+    feedbackMeter.setBounds(feedbackArea);
 
+    auto meterColumnWidth = meterArea.getWidth() / numBands;
 
+    for (int band = 0; band < numBands; ++band)
+    {
+        auto dryArea = meterArea.removeFromLeft(meterColumnWidth);
+        auto wetArea = dryArea.removeFromRight(dryArea.getWidth() / 2);
+        auto meterWidth = juce::jmin(12, dryArea.getWidth());
 
+        dryMeters[(size_t)band].setBounds(dryArea.withSizeKeepingCentre(meterWidth, dryArea.getHeight()));
+        wetMeters[(size_t)band].setBounds(wetArea.withSizeKeepingCentre(meterWidth, wetArea.getHeight()));
+    }
 
-    
+    // Spectrum under the band knobs, crossover knobs below it sit on the
+    // boundaries between the columns, their labels above them
+    auto middleArea = bounds.withBottom(meterArea.getY());
 
+    auto morphArea = middleArea.removeFromTop(26).reduced(10, 2);
 
-    
+    for (auto& button : morphStoreButtons)
+    {
+        button.setBounds(morphArea.removeFromLeft(70));
+        morphArea.removeFromLeft(6);
+    }
 
+    morphToggle.setBounds(morphArea.removeFromLeft(80));
+    morphSlider.setBounds(morphArea);
+    spectrumDisplay.setBounds(middleArea.removeFromTop(middleArea.getHeight() * 0.42).reduced(10, 4));
 
+    auto crossoverLabelHeight = 35;
+    auto crossoverSize = juce::jmin(150, columnWidth, middleArea.getHeight() - crossoverLabelHeight);
+    auto crossoverCentreY = middleArea.getCentreY() + crossoverLabelHeight / 2;
 
+    for (int i = 0; i < numBands - 1; ++i)
+    {
+        crossoverControls[(size_t)i].slider.setBounds(columnWidth * (i + 1) - crossoverSize / 2, crossoverCentreY - crossoverSize / 2,
+                                                      crossoverSize, crossoverSize);
+    }
 }
 
 std::vector<juce::Component*> BandSplitDelayAudioProcessorEditor::getComps()
 {
-    return
+    std::vector<juce::Component*> comps;
+
+    for (auto& controls : bandControls)
     {
-        &lowLabel,
-        &midLabel,
-        &highLabel,
+        comps.push_back(&controls.nameLabel);
+        comps.push_back(&controls.dryLabel);
+        comps.push_back(&controls.wetLabel);
+        comps.push_back(&controls.drySlider);
+        comps.push_back(&controls.wetSlider);
+    }
 
+    for (auto& controls : crossoverControls)
+    {
+        comps.push_back(&controls.label);
+        comps.push_back(&controls.slider);
+    }
 
-        &lowDryLabel,
-        &midDryLabel,
-        &highDryLabel,
+    for (int band = 0; band < numBands; ++band)
+    {
+        comps.push_back(&dryMeters[(size_t)band]);
+        comps.push_back(&wetMeters[(size_t)band]);
+    }
 
-        &lowWetLabel,
-        &midWetLabel,
-        &highWetLabel,
+    comps.push_back(&feedbackMeter);
+    comps.push_back(&feedbackLabel);
+    comps.push_back(&spectrumDisplay);
 
-        &lowMidCrosLabel,
-        &midHighCrosLabel,
+    for (auto& button : morphStoreButtons)
+        comps.push_back(&button);
 
-        &lowDrySlider,
-        &lowWetSlider,
-        &midDrySlider,
-        &midWetSlider,
-        &highDrySlider,
-        &highWetSlider,
+    comps.push_back(&morphToggle);
+    comps.push_back(&morphSlider);
 
-        &lowMidCrosSlider,
-        &midHighCrosSlider
-    };
-         
+    return comps;
 }
 
 std::vector<juce::Label*>  BandSplitDelayAudioProcessorEditor::getLabels()
 {
-    return {
-
-        &lowLabel,
-        &midLabel,
-        &highLabel,
+    std::vector<juce::Label*> labels;
 
+    for (auto& controls : bandControls)
+    {
+        labels.push_back(&controls.nameLabel);
+        labels.push_back(&controls.dryLabel);
+        labels.push_back(&controls.wetLabel);
+    }
 
-        &lowDryLabel,
-        &midDryLabel,
-        &highDryLabel,
+    for (auto& controls : crossoverControls)
+        labels.push_back(&controls.label);
 
-        & lowMidCrosLabel,
-        & midHighCrosLabel,
+    labels.push_back(&feedbackLabel);
 
-        &lowWetLabel,
-        &midWetLabel,
-        &highWetLabel
-    };
-   
-}
\ No newline at end of file
+    return labels;
+}
@@ -10,6 +10,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "EditorLookAndFeel.h"
+#include "SpectrumDisplay.h"
 
 struct CustomRotarySlider : juce::Slider 
 {
@@ -21,11 +23,28 @@ struct CustomRotarySlider : juce::Slider
     }
 };
 
+// Vertical bar, or horizontal when wider than tall: RMS filled, peak as a
+// line, both on a decibel scale
+struct LevelMeter : juce::Component
+{
+    static constexpr float minimumDecibels = -60.0f;
+
+    // Fills every pixel, so repainting it never repaints the editor behind
+    LevelMeter() { setOpaque(true); }
+
+    void setLevel(float newPeak, float newRms);
+    void paint(juce::Graphics& g) override;
+
+    float peak{ 0.0f };
+    float rms{ 0.0f };
+};
+
 
 //==============================================================================
 /**
 */
-class BandSplitDelayAudioProcessorEditor  : public juce::AudioProcessorEditor
+class BandSplitDelayAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                            private juce::Timer
 {
 public:
     BandSplitDelayAudioProcessorEditor (BandSplitDelayAudioProcessor&);
@@ -35,50 +54,82 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
+    // Timers that trigger repaints run at most this often
+    static constexpr int maxFrameRate = 30;
+
+    static constexpr int defaultWidth = 600, defaultHeight = 650;
+    static constexpr int minWidth = 450, minHeight = 490;
+    static constexpr int maxWidth = 1500, maxHeight = 1620;
+
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     BandSplitDelayAudioProcessor& audioProcessor;
 
     using Attachment = juce::AudioProcessorValueTreeState::SliderAttachment;
-    juce::Label
-        lowLabel,
-        midLabel,
-        highLabel,
-        lowDryLabel,
-        midDryLabel,
-        highDryLabel,
-        lowWetLabel,
-        midWetLabel,
-        highWetLabel,
-        lowMidCrosLabel,
-        midHighCrosLabel;
-
-    CustomRotarySlider
-        lowDrySlider,
-        lowWetSlider,
-        midDrySlider,
-        midWetSlider,
-        highDrySlider,
-        highWetSlider,
-
-        lowMidCrosSlider,
-        midHighCrosSlider;
-
-    Attachment 
-        lowDrySliderAttachment,
-        lowWetSliderAttachment,
-        midDrySliderAttachment,
-        midWetSliderAttachment,
-        highDrySliderAttachment,
-        highWetSliderAttachment,
-
-        lowMidCrosSliderAttachment,
-        midHighCrosSliderAttachment;
+    static constexpr int numBands = Params::numBands;
+
+    // Declared first, so it outlives every component that draws with it
+    EditorLookAndFeel lookAndFeel;
+
+    // Panels behind the controls, drawn once per size and display scale
+    juce::Image backgroundCache;
+    float backgroundScale{ 0.0f };
+    void renderBackground(float scale);
+    std::array<juce::Rectangle<int>, numBands> columnAreas;
+    juce::Rectangle<int> meterPanel;
+
+    // One column per band
+    struct BandControls
+    {
+        juce::Label nameLabel, dryLabel, wetLabel;
+        CustomRotarySlider drySlider, wetSlider;
+        std::unique_ptr<Attachment> dryAttachment, wetAttachment;
+    };
+
+    // One knob on each boundary between two bands
+    struct CrossoverControls
+    {
+        juce::Label label;
+        CustomRotarySlider slider;
+        std::unique_ptr<Attachment> attachment;
+    };
+
+    std::array<BandControls, numBands> bandControls;
+    std::array<CrossoverControls, numBands - 1> crossoverControls;
+
+    // Input spectrum between the knob rows, crossovers drawn over it
+    SpectrumDisplay spectrumDisplay;
+
+    // Store buttons for every morph setup, the morph amount and its switch.
+    // Shift-click recalls a setup into the knobs instead.
+    std::array<juce::TextButton, BandSplitDelayAudioProcessor::numMorphSlots> morphStoreButtons;
+    juce::Slider morphSlider{ juce::Slider::LinearHorizontal, juce::Slider::TextBoxRight };
+    juce::ToggleButton morphToggle{ "Morph" };
+    std::unique_ptr<Attachment> morphAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> morphToggleAttachment;
+
+    // Drains the meter FIFO and lets the meters fall back between frames
+    void timerCallback() override;
+    static constexpr float meterDecayPerSecond = 0.1f; // -20 dB/s
+
+    // Dry and wet under every column, feedback along the bottom
+    std::array<LevelMeter, numBands> dryMeters, wetMeters;
+    LevelMeter feedbackMeter;
+    juce::Label feedbackLabel;
 
 
     std::vector<juce::Component*> getComps();
     std::vector<juce::Label*> getLabels();
+
+   #if BSD_PAINT_TIMING
+    // Time from paint() to paintOverChildren(), i.e. everything the editor
+    // and its children drew in one pass, shown in the top left corner
+    void paintOverChildren(juce::Graphics& g) override;
+    juce::int64 paintStartTicks{ 0 };
+    double averagePaintMilliseconds{ 0.0 };
+    double maxPaintMilliseconds{ 0.0 };
+   #endif
     
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BandSplitDelayAudioProcessorEditor)
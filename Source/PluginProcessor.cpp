@@ -23,38 +23,65 @@ BandSplitDelayAudioProcessor::BandSplitDelayAudioProcessor()
 #endif
 {
     using namespace Params;
-    const auto& params = GetParams();
+    auto& parameters = getParameters();
+    jassert(parameters.size() == Index::count);
 
-    auto floatHelper = [&apvts = this->apvts, &params](auto& param, const auto& paramName)  {
-        param = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(params.at(paramName)));
-        jassert(param != nullptr);
+    // The layout is fixed, so each parameter sits at a known index
+    auto bind = [&parameters](auto& param, int index) {
+        param = static_cast<std::remove_reference_t<decltype(param)>>(parameters[index]);
     };
 
-    floatHelper(lowMidCrossover, Names::Low_Mid_Crossover);
-    floatHelper(midHighCrossover, Names::Mid_High_Crossover);
-    
-    floatHelper(dryLowGain, Names::Low_Dry);
-    floatHelper(dryMidGain, Names::Mid_Dry);
-    floatHelper(dryHighGain, Names::High_Dry);
-    
-    floatHelper(wetLowGain, Names::Low_Wet);
-    floatHelper(wetMidGain, Names::Mid_Wet);
-    floatHelper(wetHighGain, Names::High_Wet);
+    for (int i = 0; i < numBands - 1; ++i)
+        bind(crossoverFrequencies[(size_t)i], Index::crossover(i));
 
+    for (int band = 0; band < numBands; ++band)
+    {
+        bind(dryGains[(size_t)band], Index::dry(band));
+        bind(wetGains[(size_t)band], Index::wet(band));
+        bind(reverbSizes[(size_t)band], Index::reverbSize(band));
+        bind(bandDelayTimes[(size_t)band], Index::bandDelayTime(band));
+    }
 
+    bind(delayTime, Index::delayTime);
+    bind(oversampling, Index::oversampling);
+    bind(oversamplingFilter, Index::oversamplingFilter);
+    bind(crossoverMode, Index::crossoverMode);
+    bind(morph, Index::morph);
+    bind(morphEnabled, Index::morphEnabled);
+
+   #if JUCE_DEBUG
+    // Params::Index has to follow createParameterLayout
+    auto isAt = [](const juce::AudioProcessorParameterWithID* param, const juce::String& id) {
+        return param->paramID == id;
+    };
 
-    delayTime = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(params.at(Delay_Time)));
-    jassert(delayTime != nullptr);
+    for (int i = 0; i < numBands - 1; ++i)
+        jassert(isAt(crossoverFrequencies[(size_t)i], getCrossoverName(i)));
 
-    LP.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-    HP.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-    AP.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+    for (int band = 0; band < numBands; ++band)
+    {
+        jassert(isAt(dryGains[(size_t)band], getBandParamName(band, BandParam::Dry)));
+        jassert(isAt(wetGains[(size_t)band], getBandParamName(band, BandParam::Wet)));
+        jassert(isAt(reverbSizes[(size_t)band], getBandParamName(band, BandParam::Reverb_Size)));
+        jassert(isAt(bandDelayTimes[(size_t)band], getBandParamName(band, BandParam::Delay_Time)));
+    }
+
+    jassert(isAt(delayTime, getParamID(Names::Delay_Time)));
+    jassert(isAt(oversampling, getParamID(Names::Oversampling)));
+    jassert(isAt(oversamplingFilter, getParamID(Names::Oversampling_Filter)));
+    jassert(isAt(crossoverMode, getParamID(Names::Crossover_Mode)));
+    jassert(isAt(morph, getParamID(Names::Morph)));
+    jassert(isAt(morphEnabled, getParamID(Names::Morph_Enabled)));
+   #endif
 
-    LP2.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-    HP2.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-    AP2.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+    cachedDivisions.fill(-1);
 
+    presetBank = std::make_unique<PresetBank>(getParameters(), createFactoryPresets());
 
+    morphSnapshots.fill(PresetBank::getDefaults(getParameters()));
+    publishMorphSet();
+
+    startTimer(timerIntervalMs);
 }
 
 BandSplitDelayAudioProcessor::~BandSplitDelayAudioProcessor()
@@ -96,31 +123,150 @@ bool BandSplitDelayAudioProcessor::isMidiEffect() const
 
 double BandSplitDelayAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds.load();
 }
 
 int BandSplitDelayAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return presetBank->getNumPrograms();
 }
 
 int BandSplitDelayAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram.load();
 }
 
 void BandSplitDelayAudioProcessor::setCurrentProgram (int index)
 {
+    if (!juce::isPositiveAndBelow(index, presetBank->getNumPrograms()))
+        return;
+
+    currentProgram.store(index);
+    pendingProgram.store(&presetBank->getProgram(index).snapshot);
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        notifyProgramChange();
 }
 
 const juce::String BandSplitDelayAudioProcessor::getProgramName (int index)
 {
-    return {};
+    if (!juce::isPositiveAndBelow(index, presetBank->getNumPrograms()))
+        return {};
+
+    return presetBank->getProgram(index).name;
 }
 
 void BandSplitDelayAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    if (juce::isPositiveAndBelow(index, presetBank->getNumPrograms()))
+        presetBank->setProgramName(index, newName);
+}
+
+// Audio thread. Plain stores into the parameters, their listeners are
+// called from the message thread afterwards.
+void BandSplitDelayAudioProcessor::applyPendingProgram() noexcept
+{
+    if (auto* snapshot = pendingProgram.exchange(nullptr))
+    {
+        auto& parameters = getParameters();
+
+        for (int i = 0; i < parameters.size(); ++i)
+            parameters[i]->setValue((*snapshot)[(size_t)i]);
+
+        programNeedsNotification.store(true);
+    }
+}
+
+// Message thread. Whichever of this and applyPendingProgram takes the
+// pending snapshot applies it.
+void BandSplitDelayAudioProcessor::notifyProgramChange()
+{
+    if (auto* snapshot = pendingProgram.exchange(nullptr))
+    {
+        applySnapshot(*snapshot);
+    }
+    else if (programNeedsNotification.exchange(false))
+    {
+        for (auto* parameter : getParameters())
+            parameter->sendValueChangedMessageToListeners(parameter->getValue());
+    }
+}
+
+void BandSplitDelayAudioProcessor::applySnapshot(const PresetBank::Snapshot& snapshot)
+{
+    auto& parameters = getParameters();
+    jassert((int)snapshot.size() == parameters.size());
+
+    for (int i = 0; i < parameters.size(); ++i)
+        parameters[i]->setValueNotifyingHost(snapshot[(size_t)i]);
+}
+
+std::vector<PresetBank::Preset> BandSplitDelayAudioProcessor::createFactoryPresets()
+{
+    using namespace Params;
+
+    // Band delay choices start with "Global", then the divisions
+    enum { global, sixteenth, eighth, sixth, quarter, third, half, whole };
+
+    constexpr int low = 0, high = numBands - 1;
+
+    std::vector<PresetBank::Preset> presets;
+    presets.push_back({ "Default", {} });
+
+    PresetBank::Preset slapback{ "Slapback Lows", {} };
+    slapback.values = { { getBandParamName(low, BandParam::Wet), 0.8f },
+                        { getBandParamName(low, BandParam::Delay_Time), (float)sixteenth },
+                        { getBandParamName(low, BandParam::Reverb_Size), 0.2f } };
+
+    for (int band = 1; band < numBands; ++band)
+        slapback.values.push_back({ getBandParamName(band, BandParam::Wet), 0.0f });
+
+    presets.push_back(slapback);
+
+    PresetBank::Preset airy{ "Airy Highs", {} };
+    airy.values = { { getBandParamName(high, BandParam::Wet), 0.8f },
+                    { getBandParamName(high, BandParam::Delay_Time), (float)quarter },
+                    { getBandParamName(high, BandParam::Reverb_Size), 0.9f } };
+
+    for (int band = 0; band < high; ++band)
+        airy.values.push_back({ getBandParamName(band, BandParam::Wet), 0.1f });
+
+    presets.push_back(airy);
+
+    PresetBank::Preset triplets{ "Triplet Echoes", {} };
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        triplets.values.push_back({ getBandParamName(band, BandParam::Wet), 0.6f });
+        triplets.values.push_back({ getBandParamName(band, BandParam::Delay_Time), (float)third });
+    }
+
+    presets.push_back(triplets);
+
+    PresetBank::Preset wash{ "Dub Wash", {} };
+    // The global Delay Time has no "Global" entry
+    wash.values = { { getParamID(Names::Delay_Time), (float)(half - 1) } };
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        wash.values.push_back({ getBandParamName(band, BandParam::Wet), band == low ? 0.3f : 0.7f });
+        wash.values.push_back({ getBandParamName(band, BandParam::Reverb_Size), 0.85f });
+    }
+
+    presets.push_back(wash);
+
+    PresetBank::Preset mastering{ "Clean Split (Linear Phase)", {} };
+    mastering.values = { { getParamID(Names::Crossover_Mode), 1.0f } };
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        mastering.values.push_back({ getBandParamName(band, BandParam::Dry), 1.0f });
+        mastering.values.push_back({ getBandParamName(band, BandParam::Wet), 0.0f });
+    }
+
+    presets.push_back(mastering);
+
+    return presets;
 }
 
 //==============================================================================
@@ -131,41 +277,80 @@ void BandSplitDelayAudioProcessor::prepareToPlay (double sampleRate, int samples
 
 
 
-    wetBuffer.setSize(getTotalNumOutputChannels(), sampleRate);
-
-    auto delayBufferSize = sampleRate * 2;
-    for (auto& buffer : delayBuffers) {
-        buffer.setSize(getTotalNumOutputChannels(), (int)delayBufferSize);
-    }
-
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = samplesPerBlock;
     spec.numChannels = getTotalNumOutputChannels();
     spec.sampleRate = sampleRate;
+    processSpec = spec;
+
+    // The delay lines and reverb are most of an instance's memory. Sessions
+    // open faster, and tracks that never play cost little, when they wait
+    // for the first non-silent block to ask for it. Bounces, and instances
+    // that already had it, get it right away.
+    auto allocateNow = isNonRealtime() || audioMemoryReady.load();
+    audioMemoryReady = false;
+    audioMemoryRequested = false;
+
+    if (allocateNow)
+        allocateAudioMemory();
+    else
+        startTimer(memoryRequestPollMs);
 
-    LP.prepare(spec);
-    HP.prepare(spec);
-    AP.prepare(spec);
+    resetSmoothers(sampleRate);
+    analyzer.setSampleRate(sampleRate);
 
-    LP2.prepare(spec);
-    HP2.prepare(spec);
-    AP2.prepare(spec);
+    // Every factor is ready, so switching later never allocates
+    for (size_t i = 0; i < crossovers.size(); ++i)
+    {
+        auto oversampledSpec = spec;
+        oversampledSpec.sampleRate = sampleRate * (1 << i);
+        oversampledSpec.maximumBlockSize = (juce::uint32)(samplesPerBlock << i);
+        crossovers[i].prepare(oversampledSpec);
+    }
 
-    lowReverb.prepare(spec);
-    midReverb.prepare(spec);
-    highReverb.prepare(spec);
+    // Hosts pick the precision before preparing
+    doublePrecision = isUsingDoublePrecision();
 
-    /*lowReverb.setSampleRate(sampleRate);
-    midReverb.setSampleRate(sampleRate);
-    highReverb.setSampleRate(sampleRate);*/
+    if (doublePrecision)
+        doubleCrossover.prepare(spec);
 
-    for (auto& buffer : filterBuffers) 
-    {
-        buffer.setSize(spec.numChannels, samplesPerBlock);
+    inputOversampler.prepare((int)spec.numChannels, samplesPerBlock);
 
-    }
+    for (auto& oversampler : bandOversamplers)
+        oversampler.prepare((int)spec.numChannels, samplesPerBlock);
+
+    oversampledInput.setSize((int)spec.numChannels, samplesPerBlock * Oversampler::maxFactor);
+
+    for (auto& buffer : oversampledBands)
+        buffer.setSize((int)spec.numChannels, samplesPerBlock * Oversampler::maxFactor);
+
+    // Redesigned for the new sample rate if it is in use
+    linearPhaseCrossover.release();
+    updateCrossoverMode();
+
+    mixer.reset();
+
+    silentInputSamples = 0;
+    idle = false;
+    updateTailLength();
 
+    // Band workspace, processBlock never resizes these beyond samplesPerBlock
+    maxBlockSize = samplesPerBlock;
+    updateWorkerPool();
 
+    // Only the precision in use gets memory. Double precision keeps the
+    // float band buffers for the paths that split in float.
+    auto numChannels = (int)spec.numChannels;
+    auto sizeBuffers = [numChannels, samplesPerBlock](auto& buffers, bool isUsed) {
+        for (auto& buffer : buffers)
+            buffer.setSize(isUsed ? numChannels : 0, isUsed ? samplesPerBlock : 0);
+    };
+
+    sizeBuffers(floatWorkspace.filterBuffers, true);
+    sizeBuffers(floatWorkspace.dryBuffers, !doublePrecision);
+    sizeBuffers(doubleWorkspace.filterBuffers, doublePrecision);
+    sizeBuffers(doubleWorkspace.dryBuffers, doublePrecision);
+    floatInput.setSize(doublePrecision ? numChannels : 0, doublePrecision ? samplesPerBlock : 0);
 }
 
 void BandSplitDelayAudioProcessor::releaseResources()
@@ -181,12 +366,12 @@ bool BandSplitDelayAudioProcessor::isBusesLayoutSupported (const BusesLayout& la
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout up to maxNumChannels works, named (5.1, 7.1.4, ambisonics)
+    // or discrete: every channel goes through the same processing and the
+    // crossover filters them in SIMD groups
+    auto numChannels = layouts.getMainOutputChannelSet().size();
+
+    if (layouts.getMainOutputChannelSet().isDisabled() || numChannels > maxNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -200,8 +385,27 @@ bool BandSplitDelayAudioProcessor::isBusesLayoutSupported (const BusesLayout& la
 }
 #endif
 
-void BandSplitDelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void BandSplitDelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    jassert(!doublePrecision);
+    processSamples(buffer);
+}
+
+void BandSplitDelayAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    jassert(doublePrecision);
+    processSamples(buffer);
+}
+
+bool BandSplitDelayAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+template <typename SampleType>
+void BandSplitDelayAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer)
 {
+    RealtimeCheck::ScopedRealtimeSection realtimeSection;
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -211,232 +415,660 @@ void BandSplitDelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
 
     if (auto* playHead = getPlayHead())
     {
-        juce::AudioPlayHead::CurrentPositionInfo info;
-        playHead->getCurrentPosition(info);
-        bpm = info.bpm;
+        if (auto position = playHead->getPosition())
+        {
+            if (auto hostBpm = position->getBpm(); hostBpm.hasValue() && *hostBpm > 0.0)
+                bpm = *hostBpm;
+        }
     }
 
-    
+    analyzer.pushSamples(buffer);
+    applyPendingProgram();
 
+    // Until the timer has allocated it, the bands skip the delays and reverb
+    hasAudioMemory = audioMemoryReady.load();
 
-    for ( auto& fb : filterBuffers)
+    // One morph set for the whole block
+    activeMorphSet = morphEnabled->get() ? &morphSets.read() : nullptr;
+
+    updateDelayTimes(getSampleRate());
+    updateSmootherTargets();
+
+    // Silence in and every tail died away, nothing left to compute
+    if (isSilent(buffer))
     {
-        fb = buffer;
+        silentInputSamples += buffer.getNumSamples();
+
+        if (idle)
+        {
+            buffer.clear();
+            return;
+        }
     }
-    // Setting cutoffs for filters
-    auto lowCutoff = lowMidCrossover->get();
-    auto highCutoff = midHighCrossover->get();
-    auto cutoff = lowMidCrossover->get();
+    else
+    {
+        silentInputSamples = 0;
+
+        if (!hasAudioMemory)
+            audioMemoryRequested = true;
 
-    //auto curDelayTime = delayTime->getCurrentChoiceName();
+        // Parameters moved while idle apply right away instead of gliding
+        if (idle)
+        {
+            resetSmoothers(getSampleRate());
+            mixer.reset();
+            idle = false;
+        }
+    }
 
-    LP.setCutoffFrequency(lowCutoff);
-    HP.setCutoffFrequency(lowCutoff);
-    AP.setCutoffFrequency(highCutoff);
+    // The workspace is only as big as the block size given to prepareToPlay,
+    // so anything larger from the host is processed in pieces. Short pieces
+    // only while a parameter glides, static settings cost nothing extra.
+    jassert(maxBlockSize > 0);
+    if (maxBlockSize <= 0)
+        return;
 
-    LP2.setCutoffFrequency(highCutoff);
-    HP2.setCutoffFrequency(highCutoff);
+    // Read once, so every sub-block of this block agrees
+    metering = meters.isActive();
 
-    
+    auto numSamples = buffer.getNumSamples();
+    for (int start = 0; start < numSamples;)
+    {
+        auto subBlockSize = isAutomationRamping() ? juce::jmin(automationSubBlockSize, maxBlockSize) : maxBlockSize;
+        subBlockSize = juce::jmin(subBlockSize, numSamples - start);
 
-    //Block of audio to be processed(split) by bands
-    auto fb0Block = juce::dsp::AudioBlock<float>(filterBuffers[0]);
-    auto fb1Block = juce::dsp::AudioBlock<float>(filterBuffers[1]);
-    auto fb2Block = juce::dsp::AudioBlock<float>(filterBuffers[2]);
-    auto fb0Context = juce::dsp::ProcessContextReplacing<float>(fb0Block);
-    auto fb1Context = juce::dsp::ProcessContextReplacing<float>(fb1Block);
-    auto fb2Context = juce::dsp::ProcessContextReplacing<float>(fb2Block);
+        juce::AudioBuffer<SampleType> subBlock(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, subBlockSize);
+        processSubBlock(subBlock);
+        start += subBlockSize;
+    }
 
+    if (metering)
+        meters.push(TempoSyncedDelay::feedback);
 
-    
+    updateTailLength();
 
-    //Processing the audio
-    LP.process(fb0Context);
-    AP2.process(fb1Context);
+    auto tailSamples = (juce::int64)(tailLengthSeconds.load() * getSampleRate());
 
-    HP.process(fb1Context);
-    filterBuffers[2] = filterBuffers[1];
+    if (silentInputSamples > tailSamples && isSilent(buffer))
+        enterIdle();
+}
+
+template <typename SampleType>
+void BandSplitDelayAudioProcessor::processSubBlock(juce::AudioBuffer<SampleType>& buffer)
+{
+    auto numSamples = buffer.getNumSamples();
+    auto& filterBuffers = getWorkspace<SampleType>().filterBuffers;
+    auto& dryBuffers = getWorkspace<SampleType>().dryBuffers;
+
+    // Only resizes within the memory reserved in prepareToPlay
+    for (auto& fb : filterBuffers)
+    {
+        fb.setSize(buffer.getNumChannels(), numSamples, false, false, true);
+    }
+
+    // Every stage ramps from the previous sub-block's values to the ones
+    // the smoothers reach at the end of this one
+
+    //Splitting the audio into bands in one pass
+    std::array<float, numBands - 1> frequencies;
+
+    for (size_t i = 0; i < frequencies.size(); i++)
+    {
+        frequencies[i] = crossoverSmoothers[i].skip(numSamples);
+    }
 
-    LP2.process(fb1Context);
-    HP2.process(fb2Context);
+    splitBands(buffer, frequencies);
     //===
     
-    auto i = 0;
-    for (auto& buffer : filterBuffers) {
-        dryBuffers[i] = buffer;
-        i++;
+    // Bands are independent until the mix
+    auto processBand = [this, &filterBuffers, &dryBuffers](int band) {
+        dryBuffers[(size_t)band].makeCopyOf(filterBuffers[(size_t)band], true);
+
+        if (hasAudioMemory)
+            delays[(size_t)band].process(filterBuffers[(size_t)band]);
+
+        if (metering)
+            meters.measureBand(band, dryBuffers[(size_t)band], filterBuffers[(size_t)band]);
+    };
+
+    auto runInParallel = workerPool != nullptr && numSamples >= parallelBlockThreshold;
+
+    if (runInParallel)
+    {
+        workerPool->run(numBands, processBand);
+    }
+    else
+    {
+        for (int band = 0; band < numBands; band++)
+            processBand(band);
+    }
+    
+    //Controlling volume of bands and summing them into the output
+    for (int band = 0; band < numBands; band++)
+    {
+        mixer.setBandGains(band, drySmoothers[(size_t)band].skip(numSamples), wetSmoothers[(size_t)band].skip(numSamples));
     }
 
+    // Each band's mix replaces its wet buffer to feed the reverb
+    mixer.process(buffer, dryBuffers, filterBuffers, &filterBuffers);
+    //=====
 
+    //Reverberating every band with its own size, added on top of the mix
+    for (int band = 0; band < numBands; band++)
+    {
+        reverb.setBandSize(band, reverbSizeSmoothers[(size_t)band].skip(numSamples));
+    }
 
-    buffer.clear();
+    if (!hasAudioMemory)
+        return;
 
-    for (int channel = 0; channel < totalNumInputChannels; channel++)
+    if (runInParallel)
     {
+        auto processReverbChannel = [this, &buffer, &filterBuffers](int channel) {
+            reverb.processChannel(channel, filterBuffers, buffer);
+        };
 
-        for (size_t i = 0; i < 3; i++)
-        {
-            fillBuffer(filterBuffers[i], delayBuffers[i], channel);
-            readFromBuffer(filterBuffers[i], delayBuffers[i], channel);
-            fillBuffer(filterBuffers[i], delayBuffers[i], channel);
+        workerPool->run(reverb.getNumChannels(), processReverbChannel);
+    }
+    else
+    {
+        reverb.process(filterBuffers, buffer);
+    }
+}
 
-        }
+void BandSplitDelayAudioProcessor::splitBands(const juce::AudioBuffer<float>& buffer, const std::array<float, numBands - 1>& frequencies)
+{
+    auto& filterBuffers = floatWorkspace.filterBuffers;
+
+    if (linearPhase)
+    {
+        linearPhaseCrossover.setCrossoverFrequencies(frequencies);
+        linearPhaseCrossover.process(buffer, filterBuffers);
+        return;
+    }
 
+    auto& crossover = getCrossover();
+    crossover.setCrossoverFrequencies(frequencies);
 
+    if (oversamplingFactor == 1)
+    {
+        crossover.process(buffer, filterBuffers);
+        return;
     }
-    
-    //Controlling volume of bands
-    dryBuffers[0].applyGain(*dryLowGain);
-    dryBuffers[1].applyGain(*dryMidGain);
-    dryBuffers[2].applyGain(*dryHighGain);
 
+    auto numSamples = buffer.getNumSamples();
+    auto numChannels = buffer.getNumChannels();
+    auto numOversampled = numSamples * oversamplingFactor;
 
-    filterBuffers[0].applyGain(*wetLowGain);
-    filterBuffers[1].applyGain(*wetMidGain);
-    filterBuffers[2].applyGain(*wetHighGain);
-    
-    //=====
+    // Only resizes within the memory reserved in prepareToPlay
+    oversampledInput.setSize(numChannels, numOversampled, false, false, true);
 
+    for (auto& band : oversampledBands)
+        band.setSize(numChannels, numOversampled, false, false, true);
 
+    inputOversampler.processUp(buffer, oversampledInput, numSamples);
+    crossover.process(oversampledInput, oversampledBands);
 
-    for (auto& bandBuffer : filterBuffers) {
-        addFilterBand(buffer, bandBuffer);
+    for (size_t band = 0; band < (size_t)numBands; ++band)
+        bandOversamplers[band].processDown(oversampledBands[band], filterBuffers[band], numSamples);
+}
+
+void BandSplitDelayAudioProcessor::splitBands(const juce::AudioBuffer<double>& buffer, const std::array<float, numBands - 1>& frequencies)
+{
+    auto& filterBuffers = doubleWorkspace.filterBuffers;
+
+    if (!linearPhase && oversamplingFactor == 1)
+    {
+        doubleCrossover.setCrossoverFrequencies(frequencies);
+        doubleCrossover.process(buffer, filterBuffers);
+        return;
     }
 
+    // The oversamplers and the FIR crossover only run in float. Only
+    // resizes within the memory reserved in prepareToPlay.
+    for (auto& band : floatWorkspace.filterBuffers)
+        band.setSize(buffer.getNumChannels(), buffer.getNumSamples(), false, false, true);
+
+    floatInput.makeCopyOf(buffer, true);
+    splitBands(floatInput, frequencies);
+
+    for (size_t band = 0; band < (size_t)numBands; ++band)
+        filterBuffers[band].makeCopyOf(floatWorkspace.filterBuffers[band], true);
+}
+
+BandCrossover<BandSplitDelayAudioProcessor::numBands>& BandSplitDelayAudioProcessor::getCrossover() noexcept
+{
+    return crossovers[oversamplingFactor == 4 ? 2 : (oversamplingFactor == 2 ? 1 : 0)];
+}
+
+void BandSplitDelayAudioProcessor::updateCrossoverMode()
+{
+    // The FIR filters are only allocated while they are used
+    auto wasLinearPhase = linearPhase;
+    linearPhase = crossoverMode->getIndex() == 1;
 
+    if (linearPhase && !linearPhaseCrossover.isPrepared())
+    {
+        std::array<float, numBands - 1> frequencies;
 
+        for (size_t i = 0; i < frequencies.size(); i++)
+            frequencies[i] = crossoverFrequencies[i]->get();
 
-    for (auto& bandBuffer : dryBuffers) {
-        addFilterBand(buffer, bandBuffer);
+        linearPhaseCrossover.prepare(processSpec, frequencies);
+    }
+    else if (!linearPhase)
+    {
+        linearPhaseCrossover.release();
     }
 
+    // Choices are Off, 2x and 4x
+    auto factor = 1 << oversampling->getIndex();
+    auto phase = oversamplingFilter->getIndex() == 1 ? Oversampler::Phase::linear : Oversampler::Phase::minimum;
 
-    auto revBlock = juce::dsp::AudioBlock<float>(buffer);
-    auto revContext = juce::dsp::ProcessContextReplacing<float>(revBlock);
-    lowReverb.process(revContext);
+    inputOversampler.setFactor(factor);
+    inputOversampler.setPhase(phase);
 
+    for (auto& oversampler : bandOversamplers)
+    {
+        oversampler.setFactor(factor);
+        oversampler.setPhase(phase);
+    }
 
-    auto bufferSize = buffer.getNumSamples();
-    auto delayBufferSize = delayBuffers[2].getNumSamples();
+    // Crossovers only follow the frequencies while they are in use. The
+    // one taking over is reset, which also has it pick up the current
+    // frequencies at once instead of gliding from the ones it last saw.
+    if (factor != oversamplingFactor || (wasLinearPhase && !linearPhase))
+    {
+        oversamplingFactor = factor;
+        getCrossover().reset();
+        doubleCrossover.reset();
+    }
 
-    writePosition += bufferSize;
-    writePosition %= delayBufferSize;
+    // Every band takes the same path, so they all share this delay
+    if (linearPhase)
+        setLatencySamples(linearPhaseCrossover.getLatencyInSamples());
+    else
+        setLatencySamples(factor > 1 ? juce::roundToInt(inputOversampler.getLatencyInSamples()) : 0);
 }
 
-float ChangeDelayTime(int delayTimeIndex) {
-    switch (delayTimeIndex)
+bool BandSplitDelayAudioProcessor::isCrossoverModeOutdated() const
+{
+    auto phase = oversamplingFilter->getIndex() == 1 ? Oversampler::Phase::linear : Oversampler::Phase::minimum;
+
+    return (crossoverMode->getIndex() == 1) != linearPhase
+        || (1 << oversampling->getIndex()) != oversamplingFactor
+        || phase != inputOversampler.getPhase();
+}
+
+void BandSplitDelayAudioProcessor::updateTailLength()
+{
+    // The delays repeat at TempoSyncedDelay::feedback, so they take this
+    // many repeats to fall by 60 dB. Their output then rings through the
+    // reverb, whose decay time is already a 60 dB time.
+    static const auto delayRepeats = std::ceil(std::log(0.001) / std::log((double)TempoSyncedDelay::feedback));
+
+    auto longestDelay = 0;
+
+    for (auto& delay : delays)
+        longestDelay = juce::jmax(longestDelay, delay.getDelayInSamples());
+
+    auto sampleRate = getSampleRate();
+    auto delaySeconds = sampleRate > 0.0 ? delayRepeats * longestDelay / sampleRate : 0.0;
+
+    tailLengthSeconds = delaySeconds + reverb.getDecayTime();
+}
+
+void BandSplitDelayAudioProcessor::enterIdle()
+{
+    // Clear what is left of the tails, so nothing below the threshold comes
+    // back when the input returns. Once, not per block.
+    for (auto& bandCrossover : crossovers)
+        bandCrossover.reset();
+
+    doubleCrossover.reset();
+    inputOversampler.reset();
+
+    for (auto& oversampler : bandOversamplers)
+        oversampler.reset();
+
+    linearPhaseCrossover.reset();
+
+    for (auto& delay : delays)
+        delay.reset();
+
+    reverb.reset();
+
+    idle = true;
+}
+
+template <typename SampleType>
+bool BandSplitDelayAudioProcessor::isSilent(const juce::AudioBuffer<SampleType>& buffer)
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
     {
+        auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel), buffer.getNumSamples());
 
-    //Default quarter note delay
-    default:
-        return 1;
-        break;
-    
-    //16th note delay
-    case 0:
-        return 1 / 4;
-        break;
-    
-    //8th note delay
-    case 1:
-        return 1 / 2;
-        break;
-    
-    //6th note delay
-    case 2:
-        return 4 / 6;
-        break;
+        if (range.getStart() < (SampleType)-silenceThreshold || range.getEnd() > (SampleType)silenceThreshold)
+            return false;
+    }
 
-    //Quarter note delay
-    case 3:
-        return 1;
-        break;
+    return true;
+}
 
-    //Triplet delay
-    case 4:
-        return 4 / 3;
-        break;
+void BandSplitDelayAudioProcessor::resetSmoothers(double sampleRate)
+{
+    for (auto& smoother : crossoverSmoothers)
+        smoother.reset(sampleRate, automationRampSeconds);
+
+    for (auto* smoothers : { &drySmoothers, &wetSmoothers, &reverbSizeSmoothers })
+        for (auto& smoother : *smoothers)
+            smoother.reset(sampleRate, automationRampSeconds);
+
+    // Start at the current values, nothing glides into the first block
+    updateSmootherTargets();
 
-    //Half Note Delay
-    case 5:
-        return 2;
-        break;
+    for (auto& smoother : crossoverSmoothers)
+        smoother.setCurrentAndTargetValue(smoother.getTargetValue());
+
+    for (auto* smoothers : { &drySmoothers, &wetSmoothers, &reverbSizeSmoothers })
+        for (auto& smoother : *smoothers)
+            smoother.setCurrentAndTargetValue(smoother.getTargetValue());
+}
 
-    //Whole note delay
-    case 6:
-        return 4;
-        break;
+void BandSplitDelayAudioProcessor::updateSmootherTargets()
+{
+    if (activeMorphSet != nullptr)
+    {
+        updateMorphTargets();
+        return;
+    }
+
+    // setTargetValue returns early when the target is unchanged
+    for (size_t i = 0; i < crossoverSmoothers.size(); i++)
+        crossoverSmoothers[i].setTargetValue(crossoverFrequencies[i]->get());
+
+    for (size_t band = 0; band < (size_t)numBands; band++)
+    {
+        drySmoothers[band].setTargetValue(dryGains[band]->get());
+        wetSmoothers[band].setTargetValue(wetGains[band]->get());
+        reverbSizeSmoothers[band].setTargetValue(reverbSizes[band]->get());
     }
 }
 
-void BandSplitDelayAudioProcessor::readFromBuffer(
-    juce::AudioBuffer<float>& buffer, 
-    juce::AudioBuffer<float>& delayBuffer, 
-    int channel
-) {
+// The smoothers glide between successive morph positions, so every
+// sub-block gets its own interpolated values and crossover coefficients
+void BandSplitDelayAudioProcessor::updateMorphTargets() noexcept
+{
+    auto position = morph->get() * (float)(numMorphSlots - 1);
+    auto slot = juce::jmin((int)position, numMorphSlots - 2);
+    auto amount = position - (float)slot;
+
+    auto& from = (*activeMorphSet)[(size_t)slot];
+    auto& to = (*activeMorphSet)[(size_t)slot + 1];
 
-    auto readPosition = writePosition - (getSampleRate() * 0.5f);
-    int delayBufferSize = delayBuffer.getNumSamples();
-    int bufferSize = buffer.getNumSamples();
+    for (size_t i = 0; i < crossoverSmoothers.size(); i++)
+        crossoverSmoothers[i].setTargetValue(from.crossovers[i] * std::pow(to.crossovers[i] / from.crossovers[i], amount));
 
-    if (readPosition < 0) {
-        readPosition += delayBufferSize;
+    auto interpolate = [amount](float a, float b) { return a + amount * (b - a); };
+
+    for (size_t band = 0; band < (size_t)numBands; band++)
+    {
+        drySmoothers[band].setTargetValue(interpolate(from.dry[band], to.dry[band]));
+        wetSmoothers[band].setTargetValue(interpolate(from.wet[band], to.wet[band]));
+        reverbSizeSmoothers[band].setTargetValue(interpolate(from.reverbSize[band], to.reverbSize[band]));
     }
-    auto delayGain = 0.5f;
-    if (readPosition + bufferSize < delayBufferSize)
+}
+
+const BandSplitDelayAudioProcessor::MorphTarget& BandSplitDelayAudioProcessor::getNearestMorphTarget() const noexcept
+{
+    auto slot = juce::roundToInt(morph->get() * (float)(numMorphSlots - 1));
+    return (*activeMorphSet)[(size_t)juce::jlimit(0, numMorphSlots - 1, slot)];
+}
+
+void BandSplitDelayAudioProcessor::storeMorphSnapshot(int slot)
+{
+    jassert(juce::isPositiveAndBelow(slot, numMorphSlots));
+
+    auto& snapshot = morphSnapshots[(size_t)slot];
+    auto& parameters = getParameters();
+
+    for (int i = 0; i < parameters.size(); ++i)
+        snapshot[(size_t)i] = parameters[i]->getValue();
+
+    publishMorphSet();
+}
+
+void BandSplitDelayAudioProcessor::recallMorphSnapshot(int slot)
+{
+    jassert(juce::isPositiveAndBelow(slot, numMorphSlots));
+
+    auto& snapshot = morphSnapshots[(size_t)slot];
+    auto& parameters = getParameters();
+
+    // The morph controls stay where they are
+    for (int i = 0; i < parameters.size(); ++i)
+        if (parameters[i] != morph && parameters[i] != morphEnabled)
+            parameters[i]->setValueNotifyingHost(snapshot[(size_t)i]);
+}
+
+void BandSplitDelayAudioProcessor::publishMorphSet()
+{
+    auto& set = morphSets.getWriteBuffer();
+
+    for (size_t slot = 0; slot < (size_t)numMorphSlots; ++slot)
     {
-        buffer.addFromWithRamp(channel, 0, delayBuffer.getReadPointer(channel, readPosition), bufferSize, delayGain, delayGain);
+        auto& snapshot = morphSnapshots[slot];
+        auto& target = set[slot];
+
+        auto plainValue = [&snapshot](juce::RangedAudioParameter* parameter) {
+            return parameter->convertFrom0to1(snapshot[(size_t)parameter->getParameterIndex()]);
+        };
+
+        for (size_t i = 0; i < target.crossovers.size(); ++i)
+            target.crossovers[i] = plainValue(crossoverFrequencies[i]);
+
+        for (size_t band = 0; band < (size_t)numBands; ++band)
+        {
+            target.dry[band] = plainValue(dryGains[band]);
+            target.wet[band] = plainValue(wetGains[band]);
+            target.reverbSize[band] = plainValue(reverbSizes[band]);
+            target.bandDelay[band] = juce::roundToInt(plainValue(bandDelayTimes[band]));
+        }
+
+        target.delay = juce::roundToInt(plainValue(delayTime));
     }
-    else
+
+    morphSets.publish();
+}
+
+bool BandSplitDelayAudioProcessor::isAutomationRamping() const noexcept
+{
+    auto isRamping = [](const auto& smoothers) {
+        return std::any_of(smoothers.begin(), smoothers.end(), [](const auto& smoother) { return smoother.isSmoothing(); });
+    };
+
+    return isRamping(crossoverSmoothers) || isRamping(drySmoothers) || isRamping(wetSmoothers) || isRamping(reverbSizeSmoothers);
+}
+
+void BandSplitDelayAudioProcessor::updateDelayTimes(double sampleRate)
+{
+    // Delay lengths only change with tempo, sample rate or division
+    if (sampleRate <= 0.0)
+        return;
+
+    auto tempoChanged = bpm != cachedBpm || sampleRate != cachedSampleRate;
+    cachedBpm = bpm;
+    cachedSampleRate = sampleRate;
+
+    // Too slow for the delay memory, the timer will grow it
+    if (tempoChanged && bpm < slowestTempo.load())
+        slowestTempo = bpm;
+
+    for (size_t i = 0; i < delays.size(); i++)
     {
-        auto numSamplesToEnd = delayBufferSize - readPosition;
-        buffer.addFromWithRamp(channel, 0, delayBuffer.getReadPointer(channel, readPosition), numSamplesToEnd, delayGain, delayGain);
+        // Choice 0 follows the shared Delay Time, the rest are the divisions
+        auto bandChoice = bandDelayTimes[i]->getIndex();
+        auto globalDivision = delayTime->getIndex();
 
-        auto numSamplesAtStart = bufferSize - numSamplesToEnd;
-        buffer.addFromWithRamp(channel, numSamplesToEnd, delayBuffer.getReadPointer(channel, 0), numSamplesAtStart, delayGain, delayGain);
+        if (activeMorphSet != nullptr)
+        {
+            auto& nearest = getNearestMorphTarget();
+            bandChoice = nearest.bandDelay[i];
+            globalDivision = nearest.delay;
+        }
 
+        auto division = bandChoice == 0 ? globalDivision : bandChoice - 1;
 
+        if (!tempoChanged && division == cachedDivisions[i])
+            continue;
+
+        cachedDivisions[i] = division;
+        delays[i].setDelayInSamples(TempoSyncedDelay::divisionToSamples(division, bpm, sampleRate));
     }
 }
 
-void BandSplitDelayAudioProcessor::fillBuffer(
-    juce::AudioBuffer<float>& buffer,
-    juce::AudioBuffer<float>& delayBuffer,
-    int channel 
-) {
-    auto delayBufferSize = delayBuffer.getNumSamples();
+void BandSplitDelayAudioProcessor::allocateDelays(double tempoToFit)
+{
+    // Below this the memory would grow without bound, longer delays get clamped
+    constexpr auto slowestSupportedTempo = 20.0;
 
-    auto* channelData = buffer.getWritePointer(channel);
-    auto bufferSize = buffer.getNumSamples();
-    delayBufferSize = delayBuffer.getNumSamples();
+    auto tempo = juce::jmax(slowestSupportedTempo, tempoToFit);
+    auto maxDelaySeconds = TempoSyncedDelay::getLongestDivisionInBeats() * 60.0 / tempo;
 
-    if (delayBufferSize > bufferSize + writePosition)
+    for (auto& delay : delays) {
+        delay.prepare(processSpec, maxDelaySeconds, delayStorageFormat);
+    }
+
+    delayMemoryTempo = tempo;
+    slowestTempo = tempo;
+
+    // Start at the right lengths rather than crossfading to them
+    cachedDivisions.fill(-1);
+    updateDelayTimes(processSpec.sampleRate);
+
+    for (auto& delay : delays) {
+        delay.reset();
+    }
+}
+
+void BandSplitDelayAudioProcessor::allocateAudioMemory()
+{
+    allocateDelays(bpm);
+    reverb.prepare(processSpec);
+    updateTailLength();
+
+    audioMemoryReady = true;
+    startTimer(timerIntervalMs);
+}
+
+void BandSplitDelayAudioProcessor::timerCallback()
+{
+    if (audioMemoryRequested.exchange(false) && !audioMemoryReady.load() && processSpec.sampleRate > 0.0)
     {
-        delayBuffer.copyFrom(channel, writePosition, channelData, bufferSize);
+        suspendProcessing(true);
+        allocateAudioMemory();
+        suspendProcessing(false);
     }
-    else
+
+    auto tempo = slowestTempo.load();
+
+    if (audioMemoryReady.load() && tempo < delayMemoryTempo.load())
     {
-        auto numSamplesToEnd = delayBufferSize - writePosition;
-        delayBuffer.copyFrom(channel, writePosition, channelData, numSamplesToEnd);
+        // suspendProcessing waits for the current block, so nothing is
+        // reallocated under the audio thread
+        suspendProcessing(true);
+        allocateDelays(tempo);
+        suspendProcessing(false);
+    }
 
-        auto numSamplesAtStart = bufferSize - numSamplesToEnd;
-        delayBuffer.copyFrom(channel, 0, channelData + numSamplesToEnd, numSamplesAtStart);
+    notifyProgramChange();
 
+    if (processSpec.sampleRate > 0.0 && isCrossoverModeOutdated())
+    {
+        // Keeps the latency the host sees in step with the audio, and the
+        // FIR filters are allocated here rather than on the audio thread
+        suspendProcessing(true);
+        updateCrossoverMode();
+        suspendProcessing(false);
     }
 }
 
+void BandSplitDelayAudioProcessor::updateWorkerPool()
+{
+    auto needsWorkers = parallelProcessing && maxBlockSize >= parallelBlockThreshold;
 
-void BandSplitDelayAudioProcessor::addFilterBand(juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>& bandBuffer) {
+    if (!needsWorkers)
+    {
+        workerPool.reset();
+        return;
+    }
 
-    auto nc = buffer.getNumChannels();
-    auto ns = buffer.getNumSamples();
+    // The calling audio thread takes a share of the jobs too
+    auto numWorkers = juce::jlimit(0, numBands - 1, juce::SystemStats::getNumCpus() - 1);
 
-        for (auto i = 0; i < nc; i++)
-        {
-            buffer.addFrom(i, 0, bandBuffer, i, 0, ns); 
+    if (workerPool == nullptr || workerPool->getNumWorkers() != numWorkers)
+        workerPool = numWorkers > 0 ? std::make_unique<BandWorkerPool>(numWorkers) : nullptr;
+}
 
-        }
+void BandSplitDelayAudioProcessor::setParallelProcessing(bool shouldProcessInParallel)
+{
+    if (shouldProcessInParallel == parallelProcessing)
+        return;
+
+    suspendProcessing(true);
+    parallelProcessing = shouldProcessInParallel;
+    updateWorkerPool();
+    suspendProcessing(false);
+}
+
+void BandSplitDelayAudioProcessor::setDelayStorageFormat(DelayLine::SampleFormat format)
+{
+    apvts.state.setProperty("DelayStorage", DelayLine::getFormatName(format), nullptr);
+
+    if (format == delayStorageFormat)
+        return;
+
+    suspendProcessing(true);
+    delayStorageFormat = format;
+
+    if (audioMemoryReady.load())
+        allocateDelays(delayMemoryTempo.load());
+
+    suspendProcessing(false);
+}
+
+size_t BandSplitDelayAudioProcessor::getMemoryFootprint() const
+{
+    auto bufferBytes = [](const auto& buffer) {
+        return (size_t)buffer.getNumChannels() * (size_t)buffer.getNumSamples() * sizeof(*buffer.getReadPointer(0));
+    };
+
+    auto bytes = sizeof(*this);
+
+    for (auto& delay : delays)
+        bytes += delay.getMemoryFootprint();
+
+    bytes += reverb.getMemoryFootprint();
+
+    for (auto* buffers : { &floatWorkspace.filterBuffers, &floatWorkspace.dryBuffers })
+        for (auto& buffer : *buffers)
+            bytes += bufferBytes(buffer);
+
+    for (auto* buffers : { &doubleWorkspace.filterBuffers, &doubleWorkspace.dryBuffers })
+        for (auto& buffer : *buffers)
+            bytes += bufferBytes(buffer);
+
+    bytes += bufferBytes(floatInput);
+
+    bytes += linearPhaseCrossover.getMemoryFootprint();
+    bytes += bufferBytes(oversampledInput);
+
+    for (auto& buffer : oversampledBands)
+        bytes += bufferBytes(buffer);
+
+    return bytes;
 }
+
 //==============================================================================
 bool BandSplitDelayAudioProcessor::hasEditor() const
 {
@@ -452,24 +1084,47 @@ juce::AudioProcessorEditor* BandSplitDelayAudioProcessor::createEditor()
 //==============================================================================
 void BandSplitDelayAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    PresetBank::Extras extras;
+    extras.currentProgram = currentProgram.load();
+    extras.delayStorage = DelayLine::getFormatName(delayStorageFormat);
+    extras.morphSnapshots.assign(morphSnapshots.begin(), morphSnapshots.end());
 
     juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    PresetBank::writeState(mos, getParameters(), extras);
 }
 
 void BandSplitDelayAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    PresetBank::Snapshot snapshot;
+    PresetBank::Extras extras;
+
+    if (PresetBank::readState(data, sizeInBytes, getParameters(), snapshot, extras))
+    {
+        // The restored state wins over a program that hasn't been applied yet
+        pendingProgram.store(nullptr);
+        applySnapshot(snapshot);
+        currentProgram.store(juce::jlimit(0, presetBank->getNumPrograms() - 1, extras.currentProgram));
+
+        for (size_t slot = 0; slot < extras.morphSnapshots.size() && slot < morphSnapshots.size(); ++slot)
+            morphSnapshots[slot] = extras.morphSnapshots[slot];
+
+        publishMorphSet();
+
+        auto format = DelayLine::SampleFormat::float32;
+        DelayLine::getFormatFromName(extras.delayStorage, format);
+        setDelayStorageFormat(format);
+        return;
+    }
 
-    auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
+    // Sessions saved before the binary format hold a ValueTree
+    auto tree = juce::ValueTree::readFromData(data, (size_t)sizeInBytes);
     if (tree.isValid())
     {
         apvts.replaceState(tree);
-        
+
+        auto format = DelayLine::SampleFormat::float32;
+        DelayLine::getFormatFromName(tree.getProperty("DelayStorage").toString(), format);
+        setDelayStorageFormat(format);
     }
 }
 
@@ -479,70 +1134,106 @@ juce::AudioProcessorValueTreeState::ParameterLayout BandSplitDelayAudioProcessor
     
     using namespace juce;
     using namespace Params;
-    const auto& params = GetParams();
-
-    juce::StringArray delayTimes = { "1/16", "1/8", "1/6", "1/4", "1/3", "1/2", "1/1"};
-
-    layout.add(std::make_unique<AudioParameterFloat>(params.at( Names::High_Wet),
-                                                                params.at(Names::High_Wet),
-                                                                NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
-                                                                0.5f));
-    layout.add(std::make_unique<AudioParameterFloat>(params.at( Names::Mid_Wet),
-                                                                params.at(Names::Mid_Wet),
-                                                                NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
-                                                                0.5f));
-    layout.add(std::make_unique<AudioParameterFloat>(params.at( Names::Low_Wet),
-                                                                params.at(Names::Low_Wet),
-                                                                NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
-                                                                0.5f));
-    layout.add(std::make_unique<AudioParameterFloat>(params.at( Names::High_Dry),
-                                                                params.at(Names::High_Dry),
-                                                                NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
-                                                                0.5f));
-    layout.add(std::make_unique<AudioParameterFloat>(params.at( Names::Mid_Dry),
-                                                                params.at(Names::Mid_Dry),
-                                                                NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
-                                                                0.5f));
-    layout.add(std::make_unique<AudioParameterFloat>(params.at( Names::Low_Dry),
-                                                                params.at(Names::Low_Dry),
-                                                                NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
-                                                                0.5f));
-
-
-    layout.add(std::make_unique<AudioParameterFloat>(   params.at(Names::Low_Mid_Crossover),
-                                                        params.at(Names::Low_Mid_Crossover),
-                                                        NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 
-                                                        500.f));
-    layout.add(std::make_unique<AudioParameterFloat>(   params.at(Names::Mid_High_Crossover),
-                                                        params.at(Names::Mid_High_Crossover),
-                                                        NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 
-                                                        7000.f));
+
+    auto delayTimes = TempoSyncedDelay::getDivisionNames();
+
+    auto bandDelayChoices = delayTimes;
+    bandDelayChoices.insert(0, "Global");
+
+    // Same order as the original three-band layout, wet and dry from the
+    // highest band down, so hosts that address parameters by index find
+    // them where sessions of the original plugin left them
+    for (int band = numBands - 1; band >= 0; --band)
+    {
+        layout.add(std::make_unique<AudioParameterFloat>(getBandParamName(band, BandParam::Wet),
+                                                         getBandParamName(band, BandParam::Wet),
+                                                         NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+                                                         0.5f));
+    }
+
+    for (int band = numBands - 1; band >= 0; --band)
+    {
+        layout.add(std::make_unique<AudioParameterFloat>(getBandParamName(band, BandParam::Dry),
+                                                         getBandParamName(band, BandParam::Dry),
+                                                         NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+                                                         0.5f));
+    }
+
+    // Defaults spread evenly in log frequency between 500 Hz and 7 kHz
+    constexpr auto lowestDefault = 500.0f, highestDefault = 7000.0f;
+
+    for (int i = 0; i < numBands - 1; ++i)
+    {
+        auto position = numBands > 2 ? (float)i / (float)(numBands - 2) : 0.5f;
+        auto defaultFrequency = lowestDefault * std::pow(highestDefault / lowestDefault, position);
+
+        layout.add(std::make_unique<AudioParameterFloat>(   getCrossoverName(i),
+                                                            getCrossoverName(i),
+                                                            NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 
+                                                            std::round(defaultFrequency)));
+    }
+
     layout.add(std::make_unique<AudioParameterChoice>(
-        params.at(Names::Delay_Time),
-        params.at(Names::Delay_Time),
+        getParamID(Names::Delay_Time),
+        getParamID(Names::Delay_Time),
         delayTimes,
         3
         ));
 
-    layout.add(std::make_unique<AudioParameterFloat>(
-        params.at(Names::Low_Reverb_Size),
-        params.at(Names::Low_Reverb_Size),
-        NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
-        0.5f
+    for (int band = 0; band < numBands; ++band)
+    {
+        layout.add(std::make_unique<AudioParameterFloat>(
+            getBandParamName(band, BandParam::Reverb_Size),
+            getBandParamName(band, BandParam::Reverb_Size),
+            NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+            0.5f
+            ));
+    }
+
+    // Everything below was added after the original layout and is only
+    // ever appended, so the original parameters keep their indices
+    for (int band = 0; band < numBands; ++band)
+    {
+        layout.add(std::make_unique<AudioParameterChoice>(
+            getBandParamName(band, BandParam::Delay_Time),
+            getBandParamName(band, BandParam::Delay_Time),
+            bandDelayChoices,
+            0
+            ));
+    }
+
+    layout.add(std::make_unique<AudioParameterChoice>(
+        getParamID(Names::Oversampling),
+        getParamID(Names::Oversampling),
+        StringArray{ "Off", "2x", "4x" },
+        0
         ));
 
-    layout.add(std::make_unique<AudioParameterFloat>(
-        params.at(Names::Mid_Reverb_Size),
-        params.at(Names::Mid_Reverb_Size),
-        NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
-        0.5f
+    layout.add(std::make_unique<AudioParameterChoice>(
+        getParamID(Names::Oversampling_Filter),
+        getParamID(Names::Oversampling_Filter),
+        StringArray{ "Minimum Phase", "Linear Phase" },
+        0
+        ));
+
+    layout.add(std::make_unique<AudioParameterChoice>(
+        getParamID(Names::Crossover_Mode),
+        getParamID(Names::Crossover_Mode),
+        StringArray{ "Linkwitz-Riley", "Linear Phase" },
+        0
         ));
 
     layout.add(std::make_unique<AudioParameterFloat>(
-        params.at(Names::High_Reverb_Size),
-        params.at(Names::High_Reverb_Size),
-        NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
-        0.5f
+        getParamID(Names::Morph),
+        getParamID(Names::Morph),
+        NormalisableRange<float>(0.f, 1.f, 0.001f, 1.f),
+        0.f
+        ));
+
+    layout.add(std::make_unique<AudioParameterBool>(
+        getParamID(Names::Morph_Enabled),
+        getParamID(Names::Morph_Enabled),
+        false
         ));
 
 
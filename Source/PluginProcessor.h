@@ -9,52 +9,112 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BandMeters.h"
+#include "BandMixer.h"
+#include "BandReverb.h"
+#include "BandWorkerPool.h"
+#include "Crossover.h"
+#include "LinearPhaseCrossover.h"
+#include "Oversampler.h"
+#include "PresetBank.h"
+#include "RealtimeCheck.h"
+#include "SpectrumAnalyzer.h"
+#include "TempoSyncedDelay.h"
+#include "TripleBuffer.h"
+
+#ifndef BSD_NUM_BANDS
+ #define BSD_NUM_BANDS 3
+#endif
 
 namespace Params {
 
+    // Set per build with the BSD_NUM_BANDS CMake option (2 to 8)
+    constexpr int numBands = BSD_NUM_BANDS;
+
     enum Names {
+        Delay_Time,
+        Oversampling,
+        Oversampling_Filter,
+        Crossover_Mode,
+        Morph,
+        Morph_Enabled,
+    };
 
-        Low_Wet,
-        Mid_Wet,
-        High_Wet,
-        Low_Dry,
-        Mid_Dry,
-        High_Dry,
+    // Parameter IDs, indexed by Names
+    inline constexpr std::array<const char*, 6> ids{
+        "Delay Time",
+        "Oversampling",
+        "Oversampling Filter",
+        "Crossover Mode",
+        "Morph",
+        "Morph Enabled",
+    };
 
-        Low_Mid_Crossover,
-        Mid_High_Crossover,
+    constexpr const char* getParamID(Names name) { return ids[(size_t)name]; }
 
+    enum class BandParam {
+        Wet,
+        Dry,
         Delay_Time,
-
-        Low_Reverb_Size,
-        Mid_Reverb_Size,
-        High_Reverb_Size,        
+        Reverb_Size,
     };
 
-    inline const std::map<Names, juce::String>& GetParams() {
-        static std::map<Names, juce::String> params = {
-        {Low_Wet, "Low Wet"},
-        {Mid_Wet, "Mid Wet"},
-        {High_Wet, "High Wet"},
-        {Low_Dry, "Low Dry"},
-        {Mid_Dry, "Mid Dry"},
-        {High_Dry, "High Dry"},
-        {Low_Mid_Crossover, "Low Mid Crossover"},
-        {Mid_High_Crossover, "Mid High Crossover"},
-        {Delay_Time, "Delay Time"},
-        {Low_Reverb_Size, "Low Reverb Size"},
-        {Mid_Reverb_Size, "Mid Reverb Size"},
-        {High_Reverb_Size, "High Reverb Size"},
-        };
-
-        return params;
+    // "Low", "Mid", "High" for three bands, so the parameter IDs of the
+    // original three-band layout ("Low Wet", "Mid High Crossover", ...) stay
+    // the same. Other counts number the middle bands.
+    inline juce::String getBandName(int band) {
+        jassert(juce::isPositiveAndBelow(band, numBands));
+
+        if (band == 0)
+            return "Low";
+
+        if (band == numBands - 1)
+            return "High";
+
+        return numBands == 3 ? juce::String("Mid") : "Mid " + juce::String(band);
+    }
+
+    inline juce::String getBandParamName(int band, BandParam param) {
+        switch (param)
+        {
+        case BandParam::Wet:         return getBandName(band) + " Wet";
+        case BandParam::Dry:         return getBandName(band) + " Dry";
+        case BandParam::Delay_Time:  return getBandName(band) + " Delay Time";
+        case BandParam::Reverb_Size: return getBandName(band) + " Reverb Size";
+        }
+
+        return {};
+    }
+
+    // Crossover between band index and index + 1
+    inline juce::String getCrossoverName(int index) {
+        return getBandName(index) + " " + getBandName(index + 1) + " Crossover";
+    }
+
+    // Where createParameterLayout puts each parameter, which is also its
+    // index in getParameters(), so the processor picks its pointers up
+    // without looking up IDs or casting
+    namespace Index {
+        constexpr int wet(int band) { return numBands - 1 - band; }
+        constexpr int dry(int band) { return 2 * numBands - 1 - band; }
+        constexpr int crossover(int index) { return 2 * numBands + index; }
+        constexpr int delayTime = 3 * numBands - 1;
+        constexpr int reverbSize(int band) { return 3 * numBands + band; }
+        constexpr int bandDelayTime(int band) { return 4 * numBands + band; }
+        constexpr int oversampling = 5 * numBands;
+        constexpr int oversamplingFilter = oversampling + 1;
+        constexpr int crossoverMode = oversampling + 2;
+        constexpr int morph = oversampling + 3;
+        constexpr int morphEnabled = oversampling + 4;
+        constexpr int count = oversampling + 5;
     }
 }
 
 //==============================================================================
 /**
 */
-class BandSplitDelayAudioProcessor  : public juce::AudioProcessor
+class BandSplitDelayAudioProcessor  : public juce::AudioProcessor,
+                                      private juce::Timer
 {
 public:
     //==============================================================================
@@ -69,7 +129,15 @@ public:
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
    #endif
 
+    static constexpr int maxNumChannels = 16;
+
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // Both precisions run natively. The Linkwitz-Riley crossover, delays,
+    // mixer and reverb take the host's sample type; only the oversampled
+    // and linear phase crossovers convert to float and back around the split.
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -96,63 +164,240 @@ public:
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts{ *this, nullptr, "Parameters", createParameterLayout() };
+
+    //==============================================================================
+    // The delay lines hold the longest note division at the current tempo and
+    // are regrown from the message thread when the tempo drops below that.
+    // The storage format trades precision for memory, switching it reallocates.
+    void setDelayStorageFormat(DelayLine::SampleFormat format);
+    DelayLine::SampleFormat getDelayStorageFormat() const noexcept { return delayStorageFormat; }
+
+    // Programs are flat snapshots decoded when the processor is built.
+    // setCurrentProgram applies one right away on the message thread. From
+    // the audio thread it only leaves a pointer for the next processBlock,
+    // and the editor and host are told on the next timer tick.
+    const PresetBank& getPresetBank() const noexcept { return *presetBank; }
+
+    // Stored band setups the Morph parameter moves between while Morph
+    // Enabled is on. Crossovers glide in log frequency, gains and reverb
+    // sizes linearly, and delay divisions come from the nearest setup.
+    // The knobs then only set what the next store captures.
+    static constexpr int numMorphSlots = 2;
+    void storeMorphSnapshot(int slot);
+    void recallMorphSnapshot(int slot);
+
+    // Bytes of audio memory owned by this instance. Outside of bounces the
+    // delay and reverb memory only exists once non-silent audio has arrived.
+    size_t getMemoryFootprint() const;
+
+    // Sub-blocks of at least parallelBlockThreshold samples, as in offline
+    // bounces, spread the bands and reverb channels over worker threads.
+    // The workers only exist while the prepared block size can reach that.
+    static constexpr int parallelBlockThreshold = 1024;
+    void setParallelProcessing(bool shouldProcessInParallel);
+    bool isParallelProcessingEnabled() const noexcept { return parallelProcessing; }
+
+    // Gains, crossovers and reverb sizes glide to new values over
+    // automationRampSeconds. While anything glides the block is processed in
+    // sub-blocks of automationSubBlockSize, each stage ramping across them.
+    static constexpr double automationRampSeconds = 0.02;
+    static constexpr int automationSubBlockSize = 32;
+
+    // Once the input has been below silenceThreshold for longer than the
+    // tail and the output has followed, processBlock only clears the buffer
+    static constexpr float silenceThreshold = 1.0e-5f; // -100 dB
+    bool isIdle() const noexcept { return idle; }
+
+    // The Linkwitz-Riley crossover runs at 1x, 2x or 4x, the linear phase
+    // FIR crossover always at the base rate. A new mode, factor or filter
+    // phase is picked up by the timer, which switches between the prepared
+    // stages and reports the new latency.
+    int getOversamplingFactor() const noexcept { return oversamplingFactor; }
+    bool isLinearPhase() const noexcept { return linearPhase; }
+
+    // Band and feedback levels for the editor, only measured while an
+    // editor has switched them on
+    using Meters = BandMeters<Params::numBands>;
+    Meters& getMeters() noexcept { return meters; }
+
+    // Input spectrum for the editor, fed while its thread runs
+    SpectrumAnalyzer& getAnalyzer() noexcept { return analyzer; }
     
 
 private:   
-    
+    // Lets Tools/Bench time the individual processing stages
+    friend struct ProcessorBenchmark;
+
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+
+    template <typename SampleType>
+    void processSubBlock(juce::AudioBuffer<SampleType>& buffer);
+
+    int maxBlockSize{ 0 };
+    juce::dsp::ProcessSpec processSpec{};
+
+    void updateWorkerPool();
+    std::unique_ptr<BandWorkerPool> workerPool;
+    bool parallelProcessing{ true };
+
+    void timerCallback() override;
+    static constexpr int timerIntervalMs = 500;
+
+    static constexpr int numBands = Params::numBands;
+
+    template <typename SampleType>
+    using BandBuffers = std::array<juce::AudioBuffer<SampleType>, numBands>;
+
+    //Idle Variables
+    void updateTailLength();
+    void enterIdle();
+    template <typename SampleType>
+    static bool isSilent(const juce::AudioBuffer<SampleType>& buffer);
+    std::atomic<double> tailLengthSeconds{ 0.0 };
+    juce::int64 silentInputSamples{ 0 };
+    bool idle{ false };
+    //========
+
+    //Crossover Mode Variables
+    void updateCrossoverMode();
+    bool isCrossoverModeOutdated() const;
+    LinearPhaseCrossover<numBands> linearPhaseCrossover;
+    bool linearPhase{ false };
+    juce::AudioParameterChoice* crossoverMode{ nullptr };
+    Oversampler inputOversampler;
+    std::array<Oversampler, numBands> bandOversamplers;
+    juce::AudioBuffer<float> oversampledInput;
+    BandBuffers<float> oversampledBands;
+    int oversamplingFactor{ 1 };
+    juce::AudioParameterChoice* oversampling{ nullptr };
+    juce::AudioParameterChoice* oversamplingFilter{ nullptr };
+    //========
+
+    //Automation Variables
+    void resetSmoothers(double sampleRate);
+    void updateSmootherTargets();
+    bool isAutomationRamping() const noexcept;
+    std::array<juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>, numBands - 1> crossoverSmoothers;
+    std::array<juce::SmoothedValue<float>, numBands> drySmoothers, wetSmoothers, reverbSizeSmoothers;
+    //========
+
     //Delay Variables
-    void readFromBuffer(
-        juce::AudioBuffer<float>& buffer, 
-        juce::AudioBuffer<float>& delayBuffer, 
-        int channel
-    );
-    void fillBuffer(
-        juce::AudioBuffer<float>& buffer,
-        juce::AudioBuffer<float>& delayBuffer,
-        int channel
-    );
-    float ChangeDelayTime(
-        int delayTimeIndex
-    );
-    std::array<juce::AudioBuffer<float>, 3> delayBuffers;
-    int writePosition{ 0 };
-    juce::AudioBuffer<float> lowDelayBuffer;
-    juce::AudioBuffer<float> midDelayBuffer;
-    juce::AudioBuffer<float> highDelayBuffer;
+    void updateDelayTimes(double sampleRate);
+    void allocateDelays(double tempoToFit);
+    std::array<TempoSyncedDelay, numBands> delays;
+    std::array<juce::AudioParameterChoice*, numBands> bandDelayTimes{};
+    std::array<int, numBands> cachedDivisions{};
+    double cachedBpm{ 0.0 };
+    double cachedSampleRate{ 0.0 };
+    DelayLine::SampleFormat delayStorageFormat{ DelayLine::SampleFormat::float32 };
+    std::atomic<double> delayMemoryTempo{ 0.0 };
+    std::atomic<double> slowestTempo{ 0.0 };
     juce::AudioParameterChoice* delayTime {nullptr};
-    float denominator { 4 };
     //========     
 
+    //Audio Memory Variables
+    // Polled this often while an instance waits for its delay and reverb
+    // memory, about as much of the first audio as goes without echoes
+    static constexpr int memoryRequestPollMs = 20;
+    void allocateAudioMemory();
+    std::atomic<bool> audioMemoryReady{ false };
+    std::atomic<bool> audioMemoryRequested{ false };
+    bool hasAudioMemory{ false };
+    //========
+
     //Reverb Variables
-    juce::dsp::Reverb highReverb, midReverb, lowReverb;
-    juce::dsp::Reverb::Parameters highReverbParams, midReverbParams, lowReverbParams;
+    BandReverb<numBands> reverb;
+    std::array<juce::AudioParameterFloat*, numBands> reverbSizes{};
     //========
 
     
     //Filter variables
-    using Filter = juce::dsp::LinkwitzRileyFilter<float>;
+    // Band workspace in the precision the host processes in, prepareToPlay
+    // only sizes the one in use
+    template <typename SampleType>
+    struct Workspace
+    {
+        BandBuffers<SampleType> filterBuffers;
+        BandBuffers<SampleType> dryBuffers;
+    };
 
-    void addFilterBand(juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>& bandBuffer);
-    std::array<juce::AudioBuffer<float>, 3> filterBuffers;
-    Filter LP, HP, AP;
-    Filter LP2, HP2, AP2;
-    juce::AudioParameterFloat* lowMidCrossover{ nullptr };
-    juce::AudioParameterFloat* midHighCrossover{ nullptr };
+    template <typename SampleType>
+    Workspace<SampleType>& getWorkspace() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleWorkspace;
+        else
+            return floatWorkspace;
+    }
+
+    Workspace<float> floatWorkspace;
+    Workspace<double> doubleWorkspace;
+    bool doublePrecision{ false };
+
+    // Fills the workspace's filterBuffers, at the oversampled rate when that is on
+    void splitBands(const juce::AudioBuffer<float>& buffer, const std::array<float, numBands - 1>& frequencies);
+    void splitBands(const juce::AudioBuffer<double>& buffer, const std::array<float, numBands - 1>& frequencies);
+    BandCrossover<numBands>& getCrossover() noexcept;
+
+    // Prepared at 1x, 2x and 4x
+    std::array<BandCrossover<numBands>, 3> crossovers;
 
-    juce::AudioParameterFloat* dryLowGain{ nullptr };
-    juce::AudioParameterFloat* dryMidGain{ nullptr };
-    juce::AudioParameterFloat* dryHighGain{ nullptr };
+    // The base rate crossover for double precision. The oversampled and
+    // linear phase paths split a float copy of the input into the float
+    // workspace instead.
+    BandCrossover<numBands, double> doubleCrossover;
+    juce::AudioBuffer<float> floatInput;
+    std::array<juce::AudioParameterFloat*, numBands - 1> crossoverFrequencies{};
 
-    juce::AudioParameterFloat* wetLowGain{ nullptr };
-    juce::AudioParameterFloat* wetMidGain{ nullptr };
-    juce::AudioParameterFloat* wetHighGain{ nullptr };
+    std::array<juce::AudioParameterFloat*, numBands> dryGains{};
+    std::array<juce::AudioParameterFloat*, numBands> wetGains{};
 
+    BandMixer<numBands> mixer;
     //=====
+
+    //Program Variables
+    static std::vector<PresetBank::Preset> createFactoryPresets();
+    void applyPendingProgram() noexcept;
+    void notifyProgramChange();
+    void applySnapshot(const PresetBank::Snapshot& snapshot);
+    std::unique_ptr<PresetBank> presetBank;
+    std::atomic<const PresetBank::Snapshot*> pendingProgram{ nullptr };
+    std::atomic<bool> programNeedsNotification{ false };
+    std::atomic<int> currentProgram{ 0 };
+    //=====
+
+    //Morph Variables
+    struct MorphTarget
+    {
+        std::array<float, numBands - 1> crossovers{};
+        std::array<float, numBands> dry{}, wet{}, reverbSize{};
+        std::array<int, numBands> bandDelay{};
+        int delay{ 0 };
+    };
+
+    using MorphSet = std::array<MorphTarget, numMorphSlots>;
+
+    // Converts the stored snapshots and hands them to the audio thread
+    void publishMorphSet();
+    void updateMorphTargets() noexcept;
+    const MorphTarget& getNearestMorphTarget() const noexcept;
+
+    std::array<PresetBank::Snapshot, numMorphSlots> morphSnapshots;
+    TripleBuffer<MorphSet> morphSets;
+    const MorphSet* activeMorphSet{ nullptr };
+    juce::AudioParameterFloat* morph{ nullptr };
+    juce::AudioParameterBool* morphEnabled{ nullptr };
+    //=====
+
+    //Meter Variables
+    Meters meters;
+    bool metering{ false };
+    //=====
+
+    SpectrumAnalyzer analyzer;
     
-    juce::AudioBuffer<float> wetBuffer;
-    std::array<juce::AudioBuffer<float>, 3> dryBuffers;
-    juce::AudioPlayHead* playHead{ nullptr };
-    double bpm;
+    double bpm{ 120.0 };
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BandSplitDelayAudioProcessor)
 };
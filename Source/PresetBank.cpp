@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+juce::String PresetBank::getParameterID(const juce::AudioProcessorParameter& parameter)
+{
+    if (auto* withID = dynamic_cast<const juce::AudioProcessorParameterWithID*>(&parameter))
+        return withID->paramID;
+
+    jassertfalse;
+    return {};
+}
+
+PresetBank::Snapshot PresetBank::getDefaults(const juce::Array<juce::AudioProcessorParameter*>& parameters)
+{
+    Snapshot snapshot;
+    snapshot.reserve((size_t)parameters.size());
+
+    for (auto* parameter : parameters)
+        snapshot.push_back(parameter->getDefaultValue());
+
+    return snapshot;
+}
+
+std::vector<juce::uint32> PresetBank::getHashes(const juce::Array<juce::AudioProcessorParameter*>& parameters)
+{
+    std::vector<juce::uint32> hashes;
+    hashes.reserve((size_t)parameters.size());
+
+    for (auto* parameter : parameters)
+        hashes.push_back(hashParameterID(getParameterID(*parameter).toRawUTF8()));
+
+    return hashes;
+}
+
+PresetBank::PresetBank(const juce::Array<juce::AudioProcessorParameter*>& parameters, const std::vector<Preset>& presets)
+{
+    // Matched by hash, as when reading state, rather than comparing every ID
+    auto hashes = getHashes(parameters);
+    auto defaults = getDefaults(parameters);
+    programs.reserve(presets.size());
+
+    for (auto& preset : presets)
+    {
+        Program program{ preset.name, defaults };
+
+        for (auto& [id, value] : preset.values)
+        {
+            auto found = std::find(hashes.begin(), hashes.end(), hashParameterID(id.toRawUTF8()));
+
+            // Presets are written against the parameter layout
+            jassert(found != hashes.end());
+
+            if (found == hashes.end())
+                continue;
+
+            auto index = (int)std::distance(hashes.begin(), found);
+
+            if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameters[index]))
+                program.snapshot[(size_t)index] = ranged->convertTo0to1(value);
+        }
+
+        programs.push_back(std::move(program));
+    }
+
+    // Hosts expect at least one program
+    if (programs.empty())
+        programs.push_back({ "Default", defaults });
+}
+
+//==============================================================================
+bool PresetBank::isBinaryState(const void* data, int sizeInBytes) noexcept
+{
+    return data != nullptr && sizeInBytes >= 4 && juce::ByteOrder::littleEndianInt(data) == magic;
+}
+
+void PresetBank::writePairs(juce::OutputStream& stream, const juce::Array<juce::AudioProcessorParameter*>& parameters,
+                            const Snapshot& snapshot)
+{
+    jassert((int)snapshot.size() == parameters.size());
+    stream.writeShort((short)parameters.size());
+
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameters[i]);
+        jassert(ranged != nullptr);
+
+        stream.writeInt((int)hashParameterID(getParameterID(*parameters[i]).toRawUTF8()));
+        stream.writeFloat(ranged->convertFrom0to1(snapshot[(size_t)i]));
+    }
+}
+
+bool PresetBank::readPairs(juce::InputStream& stream, const juce::Array<juce::AudioProcessorParameter*>& parameters,
+                           const std::vector<juce::uint32>& hashes, Snapshot& snapshot)
+{
+    auto numPairs = (juce::uint16)stream.readShort();
+
+    if (stream.getNumBytesRemaining() < (juce::int64)numPairs * 8)
+        return false;
+
+    snapshot = getDefaults(parameters);
+
+    for (int pair = 0; pair < numPairs; ++pair)
+    {
+        auto hash = (juce::uint32)stream.readInt();
+        auto value = stream.readFloat();
+
+        auto found = std::find(hashes.begin(), hashes.end(), hash);
+
+        if (found == hashes.end())
+            continue;
+
+        auto index = (int)std::distance(hashes.begin(), found);
+
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameters[index]))
+            snapshot[(size_t)index] = ranged->convertTo0to1(value);
+    }
+
+    return true;
+}
+
+void PresetBank::writeState(juce::OutputStream& stream, const juce::Array<juce::AudioProcessorParameter*>& parameters,
+                            const Extras& extras)
+{
+    Snapshot current;
+
+    for (auto* parameter : parameters)
+        current.push_back(parameter->getValue());
+
+    stream.writeInt((int)magic);
+    stream.writeShort((short)formatVersion);
+    stream.writeShort((short)extras.currentProgram);
+    stream.writeString(extras.delayStorage);
+    writePairs(stream, parameters, current);
+
+    stream.writeShort((short)extras.morphSnapshots.size());
+
+    for (auto& snapshot : extras.morphSnapshots)
+        writePairs(stream, parameters, snapshot);
+}
+
+bool PresetBank::readState(const void* data, int sizeInBytes, const juce::Array<juce::AudioProcessorParameter*>& parameters,
+                           Snapshot& snapshot, Extras& extras)
+{
+    if (!isBinaryState(data, sizeInBytes))
+        return false;
+
+    juce::MemoryInputStream stream(data, (size_t)sizeInBytes, false);
+    stream.readInt();
+
+    auto version = (int)stream.readShort();
+
+    if (version < 1)
+        return false;
+
+    auto hashes = getHashes(parameters);
+
+    Extras newExtras;
+    newExtras.currentProgram = (juce::uint16)stream.readShort();
+    newExtras.delayStorage = stream.readString();
+
+    Snapshot newSnapshot;
+
+    if (!readPairs(stream, parameters, hashes, newSnapshot))
+        return false;
+
+    if (version >= 2)
+    {
+        auto numMorphSnapshots = (juce::uint16)stream.readShort();
+
+        for (int i = 0; i < numMorphSnapshots; ++i)
+        {
+            Snapshot morphSnapshot;
+
+            if (!readPairs(stream, parameters, hashes, morphSnapshot))
+                return false;
+
+            newExtras.morphSnapshots.push_back(std::move(morphSnapshot));
+        }
+    }
+
+    // Fields added by later versions would follow here
+
+    snapshot = std::move(newSnapshot);
+    extras = std::move(newExtras);
+    return true;
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+
+    Plugin state in a compact binary format, and the programs behind
+    getNumPrograms/setCurrentProgram.
+
+    The state is a small header followed by one (ID hash, plain value) pair
+    per parameter:
+
+        "BSDS"      magic
+        uint16      format version
+        uint16      current program
+        string      delay storage format, see DelayLine::getFormatName
+        uint16      number of pairs
+        n x         uint32 FNV-1a hash of the parameter ID, float32 value
+
+    Version 2 appends the stored morph setups:
+
+        uint16      number of setups
+        n x         number of pairs and the pairs, as above
+
+    Values are stored unnormalised, so they survive a change to a range.
+    Parameters that aren't in the data keep their default, and pairs for
+    unknown IDs are skipped. Newer versions may only append fields.
+
+    Programs are decoded when the bank is built. Each one is kept as a
+    flat snapshot of normalised values in parameter order, so switching
+    programs only hands over a pointer, and applying one is a store per
+    parameter with no parsing or allocation.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class PresetBank
+{
+public:
+    static constexpr juce::uint32 magic = 0x53445342; // "BSDS" read little endian
+    static constexpr int formatVersion = 2;
+
+    // Normalised values in the order of the processor's parameters
+    using Snapshot = std::vector<float>;
+
+    // Parameter IDs and plain values, anything not listed is at its default
+    struct Preset
+    {
+        juce::String name;
+        std::vector<std::pair<juce::String, float>> values;
+    };
+
+    struct Program
+    {
+        juce::String name;
+        Snapshot snapshot;
+    };
+
+    // Settings stored next to the parameters
+    struct Extras
+    {
+        int currentProgram{ 0 };
+        juce::String delayStorage;
+        std::vector<Snapshot> morphSnapshots;
+    };
+
+    static constexpr juce::uint32 hashParameterID(const char* id) noexcept
+    {
+        juce::uint32 hash = 2166136261u;
+
+        for (; *id != 0; ++id)
+            hash = (hash ^ (juce::uint8)*id) * 16777619u;
+
+        return hash;
+    }
+
+    // Decodes every preset up front, not realtime safe
+    PresetBank(const juce::Array<juce::AudioProcessorParameter*>& parameters, const std::vector<Preset>& presets);
+
+    int getNumPrograms() const noexcept { return (int)programs.size(); }
+    const Program& getProgram(int index) const noexcept { return programs[(size_t)index]; }
+    void setProgramName(int index, const juce::String& newName) { programs[(size_t)index].name = newName; }
+
+    //==============================================================================
+    static void writeState(juce::OutputStream& stream, const juce::Array<juce::AudioProcessorParameter*>& parameters,
+                           const Extras& extras);
+
+    // Fills snapshot from the parameters' defaults and the data. Returns
+    // false, leaving both untouched, when the data isn't in this format.
+    static bool readState(const void* data, int sizeInBytes, const juce::Array<juce::AudioProcessorParameter*>& parameters,
+                          Snapshot& snapshot, Extras& extras);
+
+    static bool isBinaryState(const void* data, int sizeInBytes) noexcept;
+
+    static Snapshot getDefaults(const juce::Array<juce::AudioProcessorParameter*>& parameters);
+
+private:
+    static juce::String getParameterID(const juce::AudioProcessorParameter& parameter);
+    static std::vector<juce::uint32> getHashes(const juce::Array<juce::AudioProcessorParameter*>& parameters);
+
+    static void writePairs(juce::OutputStream& stream, const juce::Array<juce::AudioProcessorParameter*>& parameters,
+                           const Snapshot& snapshot);
+    static bool readPairs(juce::InputStream& stream, const juce::Array<juce::AudioProcessorParameter*>& parameters,
+                          const std::vector<juce::uint32>& hashes, Snapshot& snapshot);
+
+    std::vector<Program> programs;
+};
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeCheck.h"
+
+#if BSD_REALTIME_CHECKS
+
+#include <atomic>
+#include <cstddef>
+#include <dlfcn.h>
+#include <pthread.h>
+
+#if ! (defined (__linux__) && defined (__GLIBC__))
+ #error "BSD_REALTIME_CHECKS needs glibc, it interposes malloc and pthread_mutex_lock"
+#endif
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+}
+
+namespace {
+
+    // Constant-initialised, so reading it from inside malloc never allocates
+    thread_local bool insideRealtimeSection = false;
+
+    using MutexLockFn = int (*)(pthread_mutex_t*);
+    std::atomic<MutexLockFn> realMutexLock{ nullptr };
+
+    std::atomic<int> numViolations{ 0 };
+    std::atomic<const char*> firstViolation{ nullptr };
+
+    void report(const char* what)
+    {
+        if (!insideRealtimeSection)
+            return;
+
+        numViolations.fetch_add(1);
+
+        const char* expected = nullptr;
+        firstViolation.compare_exchange_strong(expected, what);
+    }
+}
+
+//==============================================================================
+// These replace the libc symbols for the whole process
+extern "C"
+{
+    void* malloc(size_t size)
+    {
+        report("malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t num, size_t size)
+    {
+        report("calloc");
+        return __libc_calloc(num, size);
+    }
+
+    void* realloc(void* ptr, size_t size)
+    {
+        report("realloc");
+        return __libc_realloc(ptr, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        report("aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** ptr, size_t alignment, size_t size)
+    {
+        report("posix_memalign");
+        *ptr = __libc_memalign(alignment, size);
+        return *ptr != nullptr || size == 0 ? 0 : 12; // ENOMEM
+    }
+
+    void free(void* ptr)
+    {
+        if (ptr != nullptr)
+            report("free");
+
+        __libc_free(ptr);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        report("pthread_mutex_lock");
+
+        auto fn = realMutexLock.load();
+        if (fn == nullptr)
+        {
+            fn = reinterpret_cast<MutexLockFn>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+            realMutexLock = fn;
+        }
+
+        return fn(mutex);
+    }
+}
+
+//==============================================================================
+namespace RealtimeCheck {
+
+    ScopedRealtimeSection::ScopedRealtimeSection() : wasInside(insideRealtimeSection)
+    {
+        insideRealtimeSection = true;
+    }
+
+    ScopedRealtimeSection::~ScopedRealtimeSection()
+    {
+        insideRealtimeSection = wasInside;
+    }
+
+    int getNumViolations()          { return numViolations.load(); }
+    const char* getFirstViolation() { return firstViolation.load(); }
+    bool isEnabled()                { return true; }
+
+    void resetViolations()
+    {
+        numViolations = 0;
+        firstViolation = nullptr;
+    }
+}
+
+#else
+
+namespace RealtimeCheck {
+
+    int getNumViolations()          { return 0; }
+    const char* getFirstViolation() { return nullptr; }
+    bool isEnabled()                { return false; }
+    void resetViolations()          {}
+}
+
+#endif
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.h
+
+    Debug/test aid that traps heap allocations and mutex locks made while
+    processBlock is running.
+
+    Only active when built with BSD_REALTIME_CHECKS=1 (Linux/glibc). The
+    checks interpose malloc/free and pthread_mutex_lock for the whole
+    process, so they belong in the command line tools, never in a shipped
+    plugin. In every other build ScopedRealtimeSection is an empty object.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#ifndef BSD_REALTIME_CHECKS
+ #define BSD_REALTIME_CHECKS 0
+#endif
+
+namespace RealtimeCheck {
+
+    // Marks the current thread as being inside the audio callback
+    struct ScopedRealtimeSection
+    {
+       #if BSD_REALTIME_CHECKS
+        ScopedRealtimeSection();
+        ~ScopedRealtimeSection();
+
+       private:
+        bool wasInside;
+       #endif
+    };
+
+    // Number of allocations, frees and locks seen inside a realtime section
+    int getNumViolations();
+
+    // Description of the first violation, or nullptr if there was none
+    const char* getFirstViolation();
+
+    void resetViolations();
+
+    // False when the traps are compiled out
+    bool isEnabled();
+}
@@ -0,0 +1,269 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+
+//==============================================================================
+class SpectrumAnalyzer::AnalysisThread : public juce::Thread
+{
+public:
+    explicit AnalysisThread(SpectrumAnalyzer& a) : juce::Thread("BandSplitDelay spectrum"), analyzer(a) {}
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            analyzer.analyse();
+            wait(1000 / framesPerSecond);
+        }
+    }
+
+private:
+    SpectrumAnalyzer& analyzer;
+};
+
+//==============================================================================
+float SpectrumAnalyzer::frequencyToProportion(float frequency) noexcept
+{
+    return std::log(frequency / minFrequency) / std::log(maxFrequency / minFrequency);
+}
+
+float SpectrumAnalyzer::proportionToFrequency(float proportion) noexcept
+{
+    return minFrequency * std::pow(maxFrequency / minFrequency, proportion);
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+{
+    smoothedDecibels.fill(minDecibels);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    stop();
+}
+
+void SpectrumAnalyzer::start()
+{
+    if (thread != nullptr)
+        return;
+
+    smoothedDecibels.fill(minDecibels);
+    analysedPosition = writePosition.load();
+    running.store(true);
+
+    thread = std::make_unique<AnalysisThread>(*this);
+
+   #if JUCE_VERSION >= 0x70003
+    thread->startThread(juce::Thread::Priority::background);
+   #else
+    thread->startThread(2);
+   #endif
+}
+
+void SpectrumAnalyzer::stop()
+{
+    running.store(false);
+
+    if (thread != nullptr)
+    {
+        thread->stopThread(1000);
+        thread.reset();
+    }
+}
+
+void SpectrumAnalyzer::setImageSize(int width, int height) noexcept
+{
+    requestedWidth.store(width);
+    requestedHeight.store(height);
+}
+
+juce::Image SpectrumAnalyzer::getImage() const
+{
+    const juce::SpinLock::ScopedLockType lock(imageLock);
+    return frontImage;
+}
+
+//==============================================================================
+template <typename SampleType>
+void SpectrumAnalyzer::pushSamples(const juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    if (!running.load(std::memory_order_relaxed))
+        return;
+
+    auto numChannels = buffer.getNumChannels();
+    auto numSamples = buffer.getNumSamples();
+
+    if (numChannels == 0 || numSamples == 0)
+        return;
+
+    auto position = writePosition.load(std::memory_order_relaxed);
+
+    // Only the newest ringSize samples can ever be read
+    auto skipped = juce::jmax(0, numSamples - ringSize);
+    position += skipped;
+
+    auto gain = 1.0f / (float)numChannels;
+
+    for (int done = skipped; done < numSamples;)
+    {
+        auto index = (int)(position & (ringSize - 1));
+        auto count = juce::jmin(numSamples - done, ringSize - index);
+        auto* destination = ring.data() + index;
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            juce::FloatVectorOperations::copyWithMultiply(destination, buffer.getReadPointer(0, done), gain, count);
+
+            for (int channel = 1; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::addWithMultiply(destination, buffer.getReadPointer(channel, done), gain, count);
+        }
+        else
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                SampleType sum = 0;
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    sum += buffer.getSample(channel, done + i);
+
+                destination[i] = (float)sum * gain;
+            }
+        }
+
+        done += count;
+        position += count;
+    }
+
+    writePosition.store(position, std::memory_order_release);
+}
+
+template void SpectrumAnalyzer::pushSamples<float>(const juce::AudioBuffer<float>&) noexcept;
+template void SpectrumAnalyzer::pushSamples<double>(const juce::AudioBuffer<double>&) noexcept;
+
+//==============================================================================
+bool SpectrumAnalyzer::copyNewestFrame() noexcept
+{
+    auto end = writePosition.load(std::memory_order_acquire);
+
+    if (end == analysedPosition || end < fftSize)
+        return false;
+
+    auto start = end - fftSize;
+    auto index = (int)(start & (ringSize - 1));
+    auto firstPart = juce::jmin(fftSize, ringSize - index);
+
+    std::copy(ring.begin() + index, ring.begin() + index + firstPart, fftBuffer.begin());
+    std::copy(ring.begin(), ring.begin() + (fftSize - firstPart), fftBuffer.begin() + firstPart);
+
+    // The copy has to be finished before looking at how far the audio
+    // thread has got since
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (writePosition.load(std::memory_order_relaxed) - start > ringSize)
+        return false;
+
+    analysedPosition = end;
+    return true;
+}
+
+void SpectrumAnalyzer::analyse()
+{
+    if (!copyNewestFrame())
+        return;
+
+    std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+    window.multiplyWithWindowingTable(fftBuffer.data(), (size_t)fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftBuffer.data());
+
+    // A full scale sine reaches 0 dB through the Hann window's gain of 0.5.
+    // Peaks show at once and fall back at a fixed rate.
+    auto scale = 4.0f / (float)fftSize;
+    auto fallPerFrame = 40.0f / (float)framesPerSecond;
+
+    for (size_t bin = 0; bin < (size_t)numBins; ++bin)
+    {
+        auto decibels = juce::Decibels::gainToDecibels(fftBuffer[bin] * scale, minDecibels);
+        smoothedDecibels[bin] = juce::jmax(decibels, smoothedDecibels[bin] - fallPerFrame);
+    }
+
+    auto width = requestedWidth.load();
+    auto height = requestedHeight.load();
+
+    if (width <= 0 || height <= 0)
+        return;
+
+    // The editor may still be drawing the image it was handed before
+    if (backImage.getWidth() != width || backImage.getHeight() != height || backImage.getReferenceCount() > 1)
+        backImage = juce::Image(juce::Image::ARGB, width, height, false, juce::SoftwareImageType());
+
+    render(backImage);
+
+    {
+        const juce::SpinLock::ScopedLockType lock(imageLock);
+        std::swap(frontImage, backImage);
+    }
+
+    imageGeneration.fetch_add(1, std::memory_order_release);
+}
+
+void SpectrumAnalyzer::render(juce::Image& image) const
+{
+    juce::Graphics g(image);
+    auto width = (float)image.getWidth();
+    auto height = (float)image.getHeight();
+
+    g.fillAll(juce::Colour(0xff15181c));
+
+    // Grid
+    g.setFont(10.0f);
+
+    for (auto frequency : { 50.0f, 100.0f, 200.0f, 500.0f, 1000.0f, 2000.0f, 5000.0f, 10000.0f })
+    {
+        auto x = width * frequencyToProportion(frequency);
+        g.setColour(juce::Colours::white.withAlpha(0.12f));
+        g.drawVerticalLine(juce::roundToInt(x), 0.0f, height);
+
+        g.setColour(juce::Colours::white.withAlpha(0.4f));
+        auto text = frequency >= 1000.0f ? juce::String(frequency / 1000.0f) + "k" : juce::String(frequency);
+        g.drawText(text, juce::Rectangle<float>(x + 2.0f, height - 12.0f, 30.0f, 12.0f), juce::Justification::centredLeft);
+    }
+
+    auto decibelsToY = [height](float decibels) {
+        return juce::jmap(decibels, minDecibels, maxDecibels, height, 0.0f);
+    };
+
+    g.setColour(juce::Colours::white.withAlpha(0.12f));
+
+    for (auto decibels = -18.0f; decibels > minDecibels; decibels -= 18.0f)
+        g.drawHorizontalLine(juce::roundToInt(decibelsToY(decibels)), 0.0f, width);
+
+    // One point per pixel column, interpolated between bins
+    auto binsPerHertz = (float)fftSize / (float)sampleRate.load();
+
+    juce::Path spectrum;
+    spectrum.startNewSubPath(0.0f, height);
+
+    for (int x = 0; x < image.getWidth(); ++x)
+    {
+        auto bin = proportionToFrequency((float)x / width) * binsPerHertz;
+        auto lower = juce::jlimit(0, numBins - 2, (int)bin);
+        auto fraction = juce::jlimit(0.0f, 1.0f, bin - (float)lower);
+        auto decibels = smoothedDecibels[(size_t)lower] + fraction * (smoothedDecibels[(size_t)lower + 1] - smoothedDecibels[(size_t)lower]);
+
+        spectrum.lineTo((float)x, decibelsToY(decibels));
+    }
+
+    spectrum.lineTo(width, height);
+    spectrum.closeSubPath();
+
+    g.setColour(juce::Colours::lightblue.withAlpha(0.25f));
+    g.fillPath(spectrum);
+    g.setColour(juce::Colours::lightblue);
+    g.strokePath(spectrum, juce::PathStrokeType(1.0f));
+}
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+
+    Spectrum of the plugin's input, drawn for the editor on a background
+    thread.
+
+    The audio thread only mixes the input down to mono and copies it into a
+    ring buffer, then publishes how far it has written with one atomic
+    store. About 30 times a second the analysis thread copies the newest
+    fftSize samples out of the ring and transforms them. It then smooths the
+    levels and renders the spectrum with its grid into an image. The editor
+    only blits the newest image.
+
+    The ring holds several FFT frames, so the audio thread can't overwrite a
+    frame while it is being copied unless the analysis thread stalls. A
+    frame that was overwritten during the copy is dropped.
+
+    The thread only runs while an editor is showing the analyzer, and the
+    audio thread skips the copy while it doesn't.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SpectrumAnalyzer
+{
+public:
+    static constexpr float minFrequency = 20.0f;
+    static constexpr float maxFrequency = 20000.0f;
+    static constexpr float minDecibels = -90.0f;
+    static constexpr float maxDecibels = 0.0f;
+
+    // Log frequency axis shared with whoever draws over the image
+    static float frequencyToProportion(float frequency) noexcept;
+    static float proportionToFrequency(float proportion) noexcept;
+
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer();
+
+    void setSampleRate(double newSampleRate) noexcept { sampleRate.store(newSampleRate); }
+
+    // Message thread. The image is rendered at the size last asked for.
+    void start();
+    void stop();
+    void setImageSize(int width, int height) noexcept;
+
+    // Bumped whenever a new image is ready
+    juce::uint32 getImageGeneration() const noexcept { return imageGeneration.load(std::memory_order_acquire); }
+    juce::Image getImage() const;
+
+    // Audio thread, returns at once while the analyzer isn't running.
+    // Double input is mixed down into the float ring.
+    template <typename SampleType>
+    void pushSamples(const juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+private:
+    class AnalysisThread;
+
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = fftSize / 2 + 1;
+    static constexpr int ringSize = fftSize * 4;
+    static constexpr int framesPerSecond = 30;
+
+    // Analysis thread
+    void analyse();
+    bool copyNewestFrame() noexcept;
+    void render(juce::Image& image) const;
+
+    std::atomic<bool> running{ false };
+    std::atomic<double> sampleRate{ 44100.0 };
+
+    // Written by the audio thread only, total samples in writePosition
+    std::array<float, ringSize> ring{};
+    std::atomic<juce::int64> writePosition{ 0 };
+    juce::int64 analysedPosition{ 0 };
+
+    juce::dsp::FFT fft{ fftOrder };
+    juce::dsp::WindowingFunction<float> window{ (size_t)fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+    std::array<float, fftSize * 2> fftBuffer{};
+    std::array<float, numBins> smoothedDecibels;
+
+    // Front is shown, back is drawn into, swapped under the lock
+    std::atomic<int> requestedWidth{ 0 }, requestedHeight{ 0 };
+    juce::Image frontImage, backImage;
+    mutable juce::SpinLock imageLock;
+    std::atomic<juce::uint32> imageGeneration{ 0 };
+
+    std::unique_ptr<AnalysisThread> thread;
+};
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumDisplay.h"
+
+SpectrumDisplay::SpectrumDisplay(SpectrumAnalyzer& analyzerToShow, std::vector<juce::RangedAudioParameter*> crossoverParameters,
+                                 int maxFrameRate)
+    : analyzer(analyzerToShow), crossovers(std::move(crossoverParameters)), shownValues(crossovers.size(), -1.0f)
+{
+    setOpaque(true);
+    analyzer.start();
+    startTimerHz(maxFrameRate);
+}
+
+SpectrumDisplay::~SpectrumDisplay()
+{
+    analyzer.stop();
+}
+
+void SpectrumDisplay::paint(juce::Graphics& g)
+{
+    auto image = analyzer.getImage();
+
+    if (image.isValid())
+        g.drawImage(image, getLocalBounds().toFloat());
+    else
+        g.fillAll(juce::Colour(0xff15181c));
+
+    g.setFont(11.0f);
+
+    for (size_t i = 0; i < crossovers.size(); ++i)
+    {
+        auto x = getCrossoverX(i);
+        auto highlighted = (int)i == draggedCrossover;
+
+        g.setColour(highlighted ? juce::Colours::orange : juce::Colours::yellow.withAlpha(0.8f));
+        g.fillRect(juce::Rectangle<float>(x - 1.0f, 0.0f, highlighted ? 3.0f : 2.0f, (float)getHeight()));
+
+        auto frequency = crossovers[i]->convertFrom0to1(crossovers[i]->getValue());
+        auto text = frequency >= 1000.0f ? juce::String(frequency / 1000.0f, 2) + " kHz" : juce::String(juce::roundToInt(frequency)) + " Hz";
+        g.drawText(text, juce::Rectangle<float>(x + 3.0f, 2.0f, 60.0f, 12.0f), juce::Justification::centredLeft);
+    }
+}
+
+void SpectrumDisplay::resized()
+{
+    analyzer.setImageSize(getWidth(), getHeight());
+}
+
+void SpectrumDisplay::timerCallback()
+{
+    auto changed = false;
+
+    if (auto generation = analyzer.getImageGeneration(); generation != shownGeneration)
+    {
+        shownGeneration = generation;
+        changed = true;
+    }
+
+    for (size_t i = 0; i < crossovers.size(); ++i)
+    {
+        if (auto value = crossovers[i]->getValue(); value != shownValues[i])
+        {
+            shownValues[i] = value;
+            changed = true;
+        }
+    }
+
+    if (changed)
+        repaint();
+}
+
+//==============================================================================
+float SpectrumDisplay::getCrossoverX(size_t index) const
+{
+    auto frequency = crossovers[index]->convertFrom0to1(crossovers[index]->getValue());
+    return (float)getWidth() * SpectrumAnalyzer::frequencyToProportion(frequency);
+}
+
+int SpectrumDisplay::findCrossoverAt(float x) const
+{
+    auto closest = -1;
+    auto closestDistance = grabDistance;
+
+    for (size_t i = 0; i < crossovers.size(); ++i)
+    {
+        if (auto distance = std::abs(getCrossoverX(i) - x); distance <= closestDistance)
+        {
+            closest = (int)i;
+            closestDistance = distance;
+        }
+    }
+
+    return closest;
+}
+
+void SpectrumDisplay::mouseMove(const juce::MouseEvent& event)
+{
+    setMouseCursor(findCrossoverAt(event.position.x) >= 0 ? juce::MouseCursor::LeftRightResizeCursor
+                                                          : juce::MouseCursor::NormalCursor);
+}
+
+void SpectrumDisplay::mouseDown(const juce::MouseEvent& event)
+{
+    draggedCrossover = findCrossoverAt(event.position.x);
+
+    if (draggedCrossover >= 0)
+    {
+        crossovers[(size_t)draggedCrossover]->beginChangeGesture();
+        repaint();
+    }
+}
+
+void SpectrumDisplay::mouseDrag(const juce::MouseEvent& event)
+{
+    if (draggedCrossover < 0 || getWidth() <= 0)
+        return;
+
+    auto proportion = juce::jlimit(0.0f, 1.0f, event.position.x / (float)getWidth());
+    auto* parameter = crossovers[(size_t)draggedCrossover];
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(SpectrumAnalyzer::proportionToFrequency(proportion)));
+}
+
+void SpectrumDisplay::mouseUp(const juce::MouseEvent&)
+{
+    if (draggedCrossover >= 0)
+    {
+        crossovers[(size_t)draggedCrossover]->endChangeGesture();
+        draggedCrossover = -1;
+        repaint();
+    }
+}
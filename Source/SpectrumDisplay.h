@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.h
+
+    Shows the SpectrumAnalyzer's newest image with a line on every crossover
+    frequency. The lines can be dragged to set the crossovers.
+
+    The analyzer runs for as long as a display exists. Painting only blits
+    the image and draws the lines, and the timer repaints only when either
+    has changed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectrumAnalyzer.h"
+
+class SpectrumDisplay : public juce::Component,
+                        private juce::Timer
+{
+public:
+    SpectrumDisplay(SpectrumAnalyzer& analyzerToShow, std::vector<juce::RangedAudioParameter*> crossoverParameters,
+                    int maxFrameRate);
+    ~SpectrumDisplay() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    void mouseMove(const juce::MouseEvent& event) override;
+    void mouseDown(const juce::MouseEvent& event) override;
+    void mouseDrag(const juce::MouseEvent& event) override;
+    void mouseUp(const juce::MouseEvent& event) override;
+
+private:
+    void timerCallback() override;
+
+    float getCrossoverX(size_t index) const;
+
+    // Closest crossover line within grabDistance pixels, or -1
+    int findCrossoverAt(float x) const;
+    static constexpr float grabDistance = 6.0f;
+
+    SpectrumAnalyzer& analyzer;
+    std::vector<juce::RangedAudioParameter*> crossovers;
+
+    juce::uint32 shownGeneration{ 0 };
+    std::vector<float> shownValues;
+    int draggedCrossover{ -1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumDisplay)
+};
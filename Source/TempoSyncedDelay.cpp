@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    TempoSyncedDelay.cpp
+
+  ==============================================================================
+*/
+
+#include "TempoSyncedDelay.h"
+
+juce::StringArray TempoSyncedDelay::getDivisionNames()
+{
+    return { "1/16", "1/8", "1/6", "1/4", "1/3", "1/2", "1/1" };
+}
+
+double TempoSyncedDelay::getDivisionInBeats(int divisionIndex)
+{
+    switch (divisionIndex)
+    {
+    //16th note delay
+    case 0: return 1.0 / 4.0;
+    //8th note delay
+    case 1: return 1.0 / 2.0;
+    //6th note delay
+    case 2: return 4.0 / 6.0;
+    //Quarter note delay
+    case 3: return 1.0;
+    //Triplet delay
+    case 4: return 4.0 / 3.0;
+    //Half Note Delay
+    case 5: return 2.0;
+    //Whole note delay
+    case 6: return 4.0;
+
+    //Default quarter note delay
+    default: return 1.0;
+    }
+}
+
+int TempoSyncedDelay::divisionToSamples(int divisionIndex, double bpm, double sampleRate)
+{
+    jassert(bpm > 0.0);
+    return juce::roundToInt(getDivisionInBeats(divisionIndex) * 60.0 / bpm * sampleRate);
+}
+
+double TempoSyncedDelay::getLongestDivisionInBeats()
+{
+    auto longest = 0.0;
+
+    for (int i = 0; i < getDivisionNames().size(); ++i)
+        longest = juce::jmax(longest, getDivisionInBeats(i));
+
+    return longest;
+}
+
+//==============================================================================
+void TempoSyncedDelay::prepare(const juce::dsp::ProcessSpec& spec, double maxDelaySeconds, DelayLine::SampleFormat format)
+{
+    maxDelay = juce::jmax(1, (int)std::ceil(maxDelaySeconds * spec.sampleRate));
+
+    // The extra block keeps a write of up to maximumBlockSize samples clear
+    // of the longest read
+    delayLine.setSize((int)spec.numChannels, maxDelay + (int)spec.maximumBlockSize, format);
+
+    fadeLength = juce::jmax(1, (int)(spec.sampleRate * 0.02));
+    currentDelay = juce::jlimit(1, maxDelay, currentDelay);
+    reset();
+}
+
+void TempoSyncedDelay::reset()
+{
+    delayLine.clear();
+    writePosition = 0;
+    previousDelay = currentDelay;
+    fadeRemaining = 0;
+}
+
+void TempoSyncedDelay::setDelayInSamples(int newDelayInSamples)
+{
+    newDelayInSamples = juce::jlimit(1, juce::jmax(1, maxDelay), newDelayInSamples);
+
+    if (newDelayInSamples == currentDelay)
+        return;
+
+    previousDelay = currentDelay;
+    currentDelay = newDelayInSamples;
+    fadeRemaining = fadeLength;
+}
+
+template <typename SampleType>
+void TempoSyncedDelay::process(juce::AudioBuffer<SampleType>& band)
+{
+    jassert(delayLine.getCapacity() > 0);
+
+    auto numChannels = juce::jmin(band.getNumChannels(), delayLine.getNumChannels());
+    auto numSamples = band.getNumSamples();
+
+    for (int start = 0; start < numSamples;)
+    {
+        // A chunk never reaches past the shortest active delay, so all of
+        // its reads come from samples written before it
+        auto chunkSize = juce::jmin(numSamples - start, currentDelay);
+
+        if (fadeRemaining > 0)
+            chunkSize = juce::jmin(chunkSize, previousDelay, fadeRemaining);
+
+        if (fadeRemaining > 0)
+        {
+            auto fadeStart = 1.0f - (float)fadeRemaining / (float)fadeLength;
+            auto fadeEnd = 1.0f - (float)(fadeRemaining - chunkSize) / (float)fadeLength;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                addDelayed(band, channel, start, chunkSize, previousDelay, feedback * (1.0f - fadeStart), feedback * (1.0f - fadeEnd));
+                addDelayed(band, channel, start, chunkSize, currentDelay, feedback * fadeStart, feedback * fadeEnd);
+                write(band, channel, start, chunkSize);
+            }
+
+            fadeRemaining -= chunkSize;
+        }
+        else
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                addDelayed(band, channel, start, chunkSize, currentDelay, feedback, feedback);
+                write(band, channel, start, chunkSize);
+            }
+        }
+
+        writePosition = delayLine.wrap(writePosition + chunkSize);
+        start += chunkSize;
+    }
+}
+
+template <typename SampleType>
+void TempoSyncedDelay::addDelayed(juce::AudioBuffer<SampleType>& band, int channel, int start, int numSamples,
+                                  int delay, float startGain, float endGain) const
+{
+    delayLine.addTo(band.getWritePointer(channel, start), channel, writePosition - delay, numSamples, startGain, endGain);
+}
+
+template <typename SampleType>
+void TempoSyncedDelay::write(const juce::AudioBuffer<SampleType>& band, int channel, int start, int numSamples)
+{
+    delayLine.write(channel, writePosition, band.getReadPointer(channel, start), numSamples);
+}
+
+//==============================================================================
+template void TempoSyncedDelay::process<float>(juce::AudioBuffer<float>&);
+template void TempoSyncedDelay::process<double>(juce::AudioBuffer<double>&);
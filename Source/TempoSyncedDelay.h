@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    TempoSyncedDelay.h
+
+    Feedback delay for one band. The delay length is set in samples by the
+    processor whenever tempo, sample rate or note division change; a new
+    length crossfades from the old read head to the new one instead of
+    jumping, so changes don't click.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayLine.h"
+
+class TempoSyncedDelay
+{
+public:
+    // Note divisions offered by the Delay Time parameters, shortest first
+    static juce::StringArray getDivisionNames();
+
+    // Length of a division in quarter notes
+    static double getDivisionInBeats(int divisionIndex);
+
+    static int divisionToSamples(int divisionIndex, double bpm, double sampleRate);
+
+    // Length of the longest division, what the delay memory has to hold
+    static double getLongestDivisionInBeats();
+
+    //==============================================================================
+    // Allocates the delay line, not realtime safe
+    void prepare(const juce::dsp::ProcessSpec& spec, double maxDelaySeconds,
+                 DelayLine::SampleFormat format = DelayLine::SampleFormat::float32);
+    void reset();
+
+    // Starts a crossfade when the length differs from the current one
+    void setDelayInSamples(int newDelayInSamples);
+    int getDelayInSamples() const noexcept { return currentDelay; }
+
+    // Adds the delayed signal to band and feeds the result back into the
+    // line. float or double, the line converts to its storage format.
+    template <typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& band);
+
+    size_t getMemoryFootprint() const noexcept { return delayLine.getSizeInBytes(); }
+
+    static constexpr float feedback = 0.5f;
+
+private:
+    template <typename SampleType>
+    void addDelayed(juce::AudioBuffer<SampleType>& band, int channel, int start, int numSamples,
+                    int delay, float startGain, float endGain) const;
+
+    template <typename SampleType>
+    void write(const juce::AudioBuffer<SampleType>& band, int channel, int start, int numSamples);
+
+    DelayLine delayLine;
+    int maxDelay{ 0 };
+    int writePosition{ 0 };
+
+    int currentDelay{ 1 };
+    int previousDelay{ 1 };
+    int fadeLength{ 1 };
+    int fadeRemaining{ 0 };
+};
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+
+    Hands a value from one writer thread to one reader thread, wait-free on
+    both sides. The writer fills its own buffer and publishes it by swapping
+    it with the shared middle one. The reader swaps the middle one with its
+    own when it holds something newer, and otherwise keeps reading what it
+    had. Neither side ever waits for the other or sees a half-written value,
+    and a reader that falls behind just skips to the newest value.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+template <typename Type>
+class TripleBuffer
+{
+public:
+    // Writer side. The buffer may hold an older value, overwrite all of it.
+    Type& getWriteBuffer() noexcept { return buffers[(size_t)writeIndex]; }
+
+    void publish() noexcept
+    {
+        writeIndex = middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Reader side, the newest published value
+    const Type& read() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) != 0)
+            readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+
+        return buffers[(size_t)readIndex];
+    }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit = 4;
+
+    std::array<Type, 3> buffers{};
+    std::atomic<int> middle{ 1 };
+    int writeIndex{ 0 };
+    int readIndex{ 2 };
+};
@@ -0,0 +1,531 @@
+/*
+  ==============================================================================
+
+    Microbenchmarks for BandSplitDelayAudioProcessor.
+
+    Times processBlock across block sizes, sample rates and channel counts
+    (up to 16), then each processing stage on its own and the idle bypass on
+    silent input, and reports ns per sample frame. Rows with a "-double"
+    suffix repeat the stereo 48 kHz runs in double precision.
+
+    BandSplitDelayBench [options]
+
+        --quick                  shorter runs, for a rough check
+        --save-baseline <file>   write the results as a baseline
+        --baseline <file>        compare against a baseline written earlier
+        --tolerance <percent>    slowdown that counts as a regression (default 10)
+        --editor                 also time full repaints of the editor, needs a
+                                 display; reported separately, not in baselines
+        --startup                also time constructing and preparing instances,
+                                 reported separately, not in baselines
+        --stress                 also sweep the linear phase crossover's
+                                 frequencies against its design thread and
+                                 check that the bands never jump
+
+    Exits with 1 when compared against a baseline and anything regressed,
+    or when the stress check fails.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "LinearPhaseCrossover.h"
+
+//==============================================================================
+// Has friend access to the processor so each stage can be timed in isolation.
+// The stages mirror the ones processBlock runs, in the same order.
+struct ProcessorBenchmark
+{
+    template <typename SampleType>
+    static void crossover(BandSplitDelayAudioProcessor& p, juce::AudioBuffer<SampleType>& buffer)
+    {
+        for (auto& fb : p.getWorkspace<SampleType>().filterBuffers)
+            fb.setSize(buffer.getNumChannels(), buffer.getNumSamples(), false, false, true);
+
+        std::array<float, BandSplitDelayAudioProcessor::numBands - 1> frequencies;
+
+        for (size_t i = 0; i < frequencies.size(); i++)
+            frequencies[i] = p.crossoverFrequencies[i]->get();
+
+        p.splitBands(buffer, frequencies);
+    }
+
+    template <typename SampleType>
+    static void delay(BandSplitDelayAudioProcessor& p, juce::AudioBuffer<SampleType>&)
+    {
+        auto& filterBuffers = p.getWorkspace<SampleType>().filterBuffers;
+
+        for (size_t i = 0; i < p.delays.size(); i++)
+            p.delays[i].process(filterBuffers[i]);
+    }
+
+    template <typename SampleType>
+    static void mix(BandSplitDelayAudioProcessor& p, juce::AudioBuffer<SampleType>& buffer)
+    {
+        auto& workspace = p.getWorkspace<SampleType>();
+
+        for (int band = 0; band < BandSplitDelayAudioProcessor::numBands; band++)
+            p.mixer.setBandGains(band, p.dryGains[(size_t)band]->get(), p.wetGains[(size_t)band]->get());
+
+        p.mixer.process(buffer, workspace.dryBuffers, workspace.filterBuffers, &workspace.filterBuffers);
+    }
+
+    template <typename SampleType>
+    static void reverb(BandSplitDelayAudioProcessor& p, juce::AudioBuffer<SampleType>& buffer)
+    {
+        for (int band = 0; band < BandSplitDelayAudioProcessor::numBands; band++)
+            p.reverb.setBandSize(band, p.reverbSizes[(size_t)band]->get());
+
+        p.reverb.process(p.getWorkspace<SampleType>().filterBuffers, buffer);
+    }
+};
+
+//==============================================================================
+namespace
+{
+    struct Config
+    {
+        double sampleRate;
+        int blockSize;
+        int numChannels;
+
+        juce::String getSuffix() const
+        {
+            return juce::String((int)sampleRate) + "/" + juce::String(blockSize) + "/" + juce::String(numChannels) + "ch";
+        }
+    };
+
+    // Added to the stage name, so the float rows keep their baseline names
+    template <typename SampleType>
+    juce::String getPrecisionSuffix()
+    {
+        return std::is_same_v<SampleType, double> ? "-double" : "";
+    }
+
+    struct Result
+    {
+        juce::String name;
+        double nsPerSample;
+    };
+
+    template <typename SampleType>
+    void fillWithNoise(juce::AudioBuffer<SampleType>& buffer, juce::Random& random)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            auto* data = buffer.getWritePointer(channel);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                data[i] = (SampleType)(random.nextFloat() * 0.5f - 0.25f);
+        }
+    }
+
+    // Runs fn once per block until enough audio has gone through, returns ns per sample frame
+    template <typename Fn>
+    double timeBlocks(const Config& config, double secondsOfAudio, Fn&& fn)
+    {
+        auto numBlocks = juce::jmax(16, (int)(secondsOfAudio * config.sampleRate / config.blockSize));
+
+        for (int i = 0; i < 8; ++i)
+            fn();
+
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numBlocks; ++i)
+            fn();
+
+        auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+        return seconds * 1.0e9 / ((double)numBlocks * config.blockSize);
+    }
+
+    std::unique_ptr<BandSplitDelayAudioProcessor> createProcessor(const Config& config, bool doublePrecision = false)
+    {
+        auto processor = std::make_unique<BandSplitDelayAudioProcessor>();
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(config.numChannels));
+        layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(config.numChannels));
+
+        if (!processor->setBusesLayout(layout))
+            return nullptr;
+
+        processor->setRateAndBufferSizeDetails(config.sampleRate, config.blockSize);
+        processor->setNonRealtime(true);
+        processor->setProcessingPrecision(doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                          : juce::AudioProcessor::singlePrecision);
+        processor->prepareToPlay(config.sampleRate, config.blockSize);
+        return processor;
+    }
+
+    template <typename SampleType = float>
+    void runProcessBlock(const Config& config, double secondsOfAudio, juce::Array<Result>& results)
+    {
+        auto processor = createProcessor(config, std::is_same_v<SampleType, double>);
+        if (processor == nullptr)
+            return;
+
+        juce::Random random(1234);
+        juce::AudioBuffer<SampleType> input(config.numChannels, config.blockSize), buffer(input);
+        juce::MidiBuffer midi;
+        fillWithNoise(input, random);
+
+        auto ns = timeBlocks(config, secondsOfAudio, [&]
+        {
+            buffer.makeCopyOf(input, true);
+            processor->processBlock(buffer, midi);
+        });
+
+        results.add({ "processBlock" + getPrecisionSuffix<SampleType>() + "/" + config.getSuffix(), ns });
+    }
+
+    // Silent input once every tail has died away, what an idle track costs
+    void runIdle(const Config& config, double secondsOfAudio, juce::Array<Result>& results)
+    {
+        auto processor = createProcessor(config);
+        if (processor == nullptr)
+            return;
+
+        juce::AudioBuffer<float> buffer(config.numChannels, config.blockSize);
+        juce::MidiBuffer midi;
+
+        auto maxBlocksToIdle = (int)((processor->getTailLengthSeconds() + 1.0) * config.sampleRate / config.blockSize) + 2;
+
+        for (int i = 0; i < maxBlocksToIdle && !processor->isIdle(); ++i)
+        {
+            buffer.clear();
+            processor->processBlock(buffer, midi);
+        }
+
+        if (!processor->isIdle())
+            return;
+
+        auto ns = timeBlocks(config, secondsOfAudio, [&]
+        {
+            buffer.clear();
+            processor->processBlock(buffer, midi);
+        });
+
+        results.add({ "processBlock-idle/" + config.getSuffix(), ns });
+    }
+
+    template <typename SampleType = float>
+    void runStages(const Config& config, double secondsOfAudio, juce::Array<Result>& results)
+    {
+        auto processor = createProcessor(config, std::is_same_v<SampleType, double>);
+        if (processor == nullptr)
+            return;
+
+        juce::Random random(1234);
+        juce::AudioBuffer<SampleType> input(config.numChannels, config.blockSize), buffer(input);
+        juce::MidiBuffer midi;
+        fillWithNoise(input, random);
+
+        // One full block first so every workspace buffer has its final size
+        buffer.makeCopyOf(input, true);
+        processor->processBlock(buffer, midi);
+
+        auto& p = *processor;
+        auto stage = [&](const juce::String& name, auto&& fn)
+        {
+            auto ns = timeBlocks(config, secondsOfAudio, [&]
+            {
+                buffer.makeCopyOf(input, true);
+                fn();
+            });
+
+            results.add({ name + getPrecisionSuffix<SampleType>() + "/" + config.getSuffix(), ns });
+        };
+
+        stage("crossover", [&] { ProcessorBenchmark::crossover(p, buffer); });
+        stage("delay",     [&] { ProcessorBenchmark::delay(p, buffer); });
+        stage("mix",       [&] { ProcessorBenchmark::mix(p, buffer); });
+        stage("reverb",    [&] { ProcessorBenchmark::reverb(p, buffer); });
+    }
+
+    // Paints the whole editor into an image, as a full repaint would, and
+    // prints microseconds per frame. The first paint at a size fills the
+    // caches, later ones show what a steady repaint costs.
+    void runEditorPaint(bool quick)
+    {
+        auto processor = createProcessor({ 48000.0, 512, 2 });
+        if (processor == nullptr)
+            return;
+
+        std::unique_ptr<juce::AudioProcessorEditor> editor(processor->createEditorIfNeeded());
+        if (editor == nullptr)
+            return;
+
+        const std::pair<int, int> sizes[] = { { 600, 650 }, { 1200, 1300 } };
+        auto numFrames = quick ? 20 : 200;
+
+        for (auto [width, height] : sizes)
+        {
+            editor->setSize(width, height);
+
+            for (auto scale : { 1.0f, 2.0f })
+            {
+                auto paint = [&] { return editor->createComponentSnapshot(editor->getLocalBounds(), true, scale); };
+
+                auto startTicks = juce::Time::getHighResolutionTicks();
+                paint();
+                auto firstSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+                startTicks = juce::Time::getHighResolutionTicks();
+
+                for (int i = 0; i < numFrames; ++i)
+                    paint();
+
+                auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+                auto name = "editor-paint/" + juce::String(width) + "x" + juce::String(height) + "@" + juce::String(scale, 0) + "x";
+
+                std::cout << name.paddedRight(' ', 36) << juce::String(seconds * 1.0e6 / numFrames, 1).paddedLeft(' ', 10)
+                          << " us/frame  (first " << juce::String(firstSeconds * 1.0e6, 1) << " us)" << std::endl;
+            }
+        }
+    }
+
+    // Creates instances as a host opening a session does and keeps them all
+    // alive, then prints microseconds per instance to construct and to
+    // prepare, and the memory each holds before any audio. Prepared for a
+    // bounce, the delay and reverb memory is allocated up front instead.
+    void runStartup(bool quick)
+    {
+        const Config config{ 48000.0, 512, 2 };
+        auto numInstances = quick ? 16 : 128;
+
+        for (auto nonRealtime : { false, true })
+        {
+            std::vector<std::unique_ptr<BandSplitDelayAudioProcessor>> instances;
+            instances.reserve((size_t)numInstances);
+
+            double constructSeconds = 0.0, prepareSeconds = 0.0;
+            size_t bytes = 0;
+
+            for (int i = 0; i < numInstances; ++i)
+            {
+                auto startTicks = juce::Time::getHighResolutionTicks();
+                auto processor = std::make_unique<BandSplitDelayAudioProcessor>();
+                constructSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+                processor->setRateAndBufferSizeDetails(config.sampleRate, config.blockSize);
+                processor->setNonRealtime(nonRealtime);
+
+                startTicks = juce::Time::getHighResolutionTicks();
+                processor->prepareToPlay(config.sampleRate, config.blockSize);
+                prepareSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+                bytes += processor->getMemoryFootprint();
+                instances.push_back(std::move(processor));
+            }
+
+            auto prefix = juce::String(nonRealtime ? "startup-offline/" : "startup/");
+            auto print = [&prefix](const juce::String& name, const juce::String& value, const char* unit) {
+                std::cout << (prefix + name).paddedRight(' ', 36) << value.paddedLeft(' ', 10) << unit << std::endl;
+            };
+
+            print("construct", juce::String(constructSeconds * 1.0e6 / numInstances, 1), " us/instance");
+            print("prepare", juce::String(prepareSeconds * 1.0e6 / numInstances, 1), " us/instance");
+            print("memory", juce::String((double)bytes / 1024.0 / numInstances, 1), " KiB/instance");
+        }
+    }
+
+    // Moves every crossover frequency on every block, so the design thread
+    // hands new filters over as fast as it can while the audio thread
+    // crossfades between them. Every filter set sums to a delay, and so
+    // does any crossfade between two of them, so the bands must always add
+    // up to the delayed input. A set overwritten while it is in use shows
+    // up as a jump. Returns false if one did.
+    bool runLinearPhaseStress(bool quick)
+    {
+        using Crossover = LinearPhaseCrossover<Params::numBands>;
+
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 64, numChannels = 2;
+        constexpr float tolerance = 1.0e-3f;
+
+        auto secondsToRun = quick ? 5.0 : 60.0;
+
+        // Spread evenly in log frequency and swept around those points, so
+        // they stay in order
+        constexpr float lowest = 100.0f, highest = 12000.0f;
+        std::array<float, Crossover::numSplits> centres, frequencies;
+
+        for (size_t k = 0; k < centres.size(); ++k)
+            centres[k] = lowest * std::pow(highest / lowest, ((float)k + 0.5f) / (float)centres.size());
+
+        auto sweepRange = std::pow(highest / lowest, 0.4f / (float)centres.size());
+
+        auto sweep = [&](double phase)
+        {
+            for (size_t k = 0; k < centres.size(); ++k)
+                frequencies[k] = centres[k] * std::pow(sweepRange, (float)std::sin(phase + (double)k));
+        };
+
+        sweep(0.0);
+
+        auto crossover = std::make_unique<Crossover>();
+        crossover->prepare({ sampleRate, (juce::uint32)blockSize, (juce::uint32)numChannels }, frequencies);
+
+        auto latency = crossover->getLatencyInSamples();
+        juce::AudioBuffer<float> input(numChannels, blockSize), history(numChannels, latency + blockSize);
+        Crossover::BandBuffers bands;
+
+        for (auto& band : bands)
+            band.setSize(numChannels, blockSize);
+
+        history.clear();
+
+        juce::Random random(1234);
+        auto maxError = 0.0f;
+        auto numBlocks = (juce::int64)(secondsToRun * sampleRate / blockSize);
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        juce::int64 block = 0;
+
+        // Runs as fast as it can, and at least as long in real time as the
+        // audio it covers, so the design thread gets through many sets
+        for (; block < numBlocks
+               || juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) < secondsToRun; ++block)
+        {
+            sweep((double)block * 0.05);
+            crossover->setCrossoverFrequencies(frequencies);
+
+            fillWithNoise(input, random);
+            crossover->process(input, bands);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* past = history.getWritePointer(channel);
+                std::copy(past + blockSize, past + latency + blockSize, past);
+                std::copy(input.getReadPointer(channel), input.getReadPointer(channel) + blockSize, past + latency);
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    auto sum = 0.0f;
+
+                    for (auto& band : bands)
+                        sum += band.getSample(channel, i);
+
+                    maxError = juce::jmax(maxError, std::abs(sum - past[i]));
+                }
+            }
+        }
+
+        auto passed = maxError < tolerance;
+
+        std::cout << juce::String("stress/linear-phase-crossover").paddedRight(' ', 36)
+                  << juce::String(maxError, 7).paddedLeft(' ', 10) << " max error over "
+                  << juce::String(block) << " blocks  " << (passed ? "OK" : "FAILED") << std::endl;
+
+        return passed;
+    }
+
+    std::map<juce::String, double> loadBaseline(const juce::File& file)
+    {
+        std::map<juce::String, double> baseline;
+        juce::StringArray lines;
+        file.readLines(lines);
+
+        for (auto& line : lines)
+        {
+            auto tokens = juce::StringArray::fromTokens(line, false);
+            if (tokens.size() == 2)
+                baseline[tokens[0]] = tokens[1].getDoubleValue();
+        }
+
+        return baseline;
+    }
+
+    void saveBaseline(const juce::File& file, const juce::Array<Result>& results)
+    {
+        juce::String text;
+
+        for (auto& result : results)
+            text << result.name << " " << juce::String(result.nsPerSample, 3) << juce::newLine;
+
+        file.replaceWithText(text);
+    }
+}
+
+//==============================================================================
+static int runBenchmarks(const juce::ArgumentList& args)
+{
+    auto quick = args.containsOption("--quick");
+    auto secondsOfAudio = quick ? 1.0 : 10.0;
+    auto tolerance = args.containsOption("--tolerance") ? args.getValueForOption("--tolerance").getDoubleValue() : 10.0;
+
+    const int blockSizes[] = { 32, 64, 128, 512, 2048 };
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const int channelCounts[] = { 1, 2 };
+    const int surroundChannelCounts[] = { 6, 12, 16 };
+
+    juce::Array<Result> results;
+
+    for (auto sampleRate : sampleRates)
+        for (auto blockSize : blockSizes)
+            for (auto numChannels : channelCounts)
+                runProcessBlock({ sampleRate, blockSize, numChannels }, secondsOfAudio, results);
+
+    // Surround and ambisonic widths, ns per frame should grow slower than the channel count
+    for (auto numChannels : surroundChannelCounts)
+        runProcessBlock({ 48000.0, 512, numChannels }, secondsOfAudio, results);
+
+    for (auto blockSize : blockSizes)
+        runStages({ 48000.0, blockSize, 2 }, secondsOfAudio, results);
+
+    // The same runs in double precision, next to the float ones above
+    for (auto blockSize : blockSizes)
+        runProcessBlock<double>({ 48000.0, blockSize, 2 }, secondsOfAudio, results);
+
+    for (auto blockSize : blockSizes)
+        runStages<double>({ 48000.0, blockSize, 2 }, secondsOfAudio, results);
+
+    runIdle({ 48000.0, 512, 2 }, secondsOfAudio, results);
+
+    std::map<juce::String, double> baseline;
+    if (args.containsOption("--baseline"))
+        baseline = loadBaseline(args.getExistingFileForOption("--baseline"));
+
+    auto numRegressions = 0;
+
+    for (auto& result : results)
+    {
+        std::cout << result.name.paddedRight(' ', 36) << juce::String(result.nsPerSample, 2).paddedLeft(' ', 10) << " ns/sample";
+
+        auto it = baseline.find(result.name);
+        if (it != baseline.end() && it->second > 0.0)
+        {
+            auto change = (result.nsPerSample / it->second - 1.0) * 100.0;
+            std::cout << "  " << (change >= 0.0 ? "+" : "") << juce::String(change, 1) << "%";
+
+            if (change > tolerance)
+            {
+                std::cout << "  REGRESSION";
+                ++numRegressions;
+            }
+        }
+
+        std::cout << std::endl;
+    }
+
+    if (args.containsOption("--save-baseline"))
+        saveBaseline(args.getFileForOption("--save-baseline"), results);
+
+    if (args.containsOption("--editor"))
+        runEditorPaint(quick);
+
+    if (args.containsOption("--startup"))
+        runStartup(quick);
+
+    auto stressPassed = !args.containsOption("--stress") || runLinearPhaseStress(quick);
+
+    return numRegressions > 0 || !stressPassed ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args(argc, argv);
+
+    return juce::ConsoleApplication::invokeCatchingFailures([&] { return runBenchmarks(args); });
+}
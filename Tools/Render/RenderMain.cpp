@@ -0,0 +1,233 @@
+/*
+  ==============================================================================
+
+    Headless offline renderer for BandSplitDelayAudioProcessor.
+
+    Pushes a WAV file through processBlock as fast as possible and reports
+    the throughput, so renders and measurements can run without a DAW.
+
+    BandSplitDelayRender -i in.wav -o out.wav [options]
+
+        -b, --block <n>          block size passed to prepareToPlay (default 512)
+        -t, --bpm <bpm>          fixed tempo reported by the play head (default 120)
+        --program <n>            start from factory program n, before any -p
+        -p, --param "Name=Value" set a parameter, can be repeated
+                                 (e.g. -p "Low Wet=0.3" -p "Delay Time=1/8")
+        --tail <seconds>         render this much silence after the input (default 0)
+        --delay-storage <format> delay line sample format: float32, float16, int16, int24, float64
+        --serial                 never spread the bands over worker threads
+        --list-params            print the parameter names and programs and exit
+
+    When built with BSD_REALTIME_CHECKS, any allocation or lock taken inside
+    processBlock is reported and makes the render fail.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+namespace
+{
+    // Play head with a fixed tempo that advances with every rendered block
+    struct FixedTempoPlayHead : juce::AudioPlayHead
+    {
+        juce::Optional<PositionInfo> getPosition() const override
+        {
+            PositionInfo info;
+            info.setBpm(bpm);
+            info.setTimeSignature(TimeSignature{});
+            info.setTimeInSamples(samplePosition);
+            info.setTimeInSeconds((double)samplePosition / sampleRate);
+            info.setIsPlaying(true);
+            return info;
+        }
+
+        double bpm{ 120.0 };
+        double sampleRate{ 44100.0 };
+        juce::int64 samplePosition{ 0 };
+    };
+
+    void printParams(BandSplitDelayAudioProcessor& processor)
+    {
+        for (auto* param : processor.getParameters())
+        {
+            if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(param))
+                std::cout << ranged->getParameterID() << " = " << ranged->getCurrentValueAsText() << std::endl;
+        }
+
+        std::cout << std::endl << "Programs:" << std::endl;
+
+        for (int i = 0; i < processor.getNumPrograms(); ++i)
+            std::cout << "  " << i << ": " << processor.getProgramName(i) << std::endl;
+    }
+
+    bool setParam(BandSplitDelayAudioProcessor& processor, const juce::String& assignment)
+    {
+        auto name = assignment.upToFirstOccurrenceOf("=", false, false).trim();
+        auto value = assignment.fromFirstOccurrenceOf("=", false, false).trim();
+
+        auto* param = processor.apvts.getParameter(name);
+        if (param == nullptr || value.isEmpty())
+            return false;
+
+        param->setValueNotifyingHost(param->getValueForText(value));
+        return true;
+    }
+}
+
+//==============================================================================
+static int render(const juce::ArgumentList& args)
+{
+    using juce::ConsoleApplication;
+
+    BandSplitDelayAudioProcessor processor;
+
+    if (args.containsOption("--list-params"))
+    {
+        printParams(processor);
+        return 0;
+    }
+
+    auto inputFile = args.getExistingFileForOption("-i|--input");
+    auto outputFile = args.containsOption("-o|--output") ? args.getFileForOption("-o|--output") : juce::File();
+
+    auto blockSize = args.containsOption("-b|--block") ? args.getValueForOption("-b|--block").getIntValue() : 512;
+    auto bpm = args.containsOption("-t|--bpm") ? args.getValueForOption("-t|--bpm").getDoubleValue() : 120.0;
+    auto tailSeconds = args.containsOption("--tail") ? args.getValueForOption("--tail").getDoubleValue() : 0.0;
+
+    if (blockSize <= 0 || bpm <= 0.0 || tailSeconds < 0.0)
+        ConsoleApplication::fail("Block size and bpm must be positive, tail must not be negative");
+
+    if (args.containsOption("--delay-storage"))
+    {
+        auto format = DelayLine::SampleFormat::float32;
+        auto name = args.getValueForOption("--delay-storage");
+
+        if (!DelayLine::getFormatFromName(name, format))
+            ConsoleApplication::fail("Unknown delay storage format: " + name);
+
+        processor.setDelayStorageFormat(format);
+    }
+
+    if (args.containsOption("--serial"))
+        processor.setParallelProcessing(false);
+
+    if (args.containsOption("--program"))
+    {
+        auto program = args.getValueForOption("--program").getIntValue();
+
+        if (!juce::isPositiveAndBelow(program, processor.getNumPrograms()))
+            ConsoleApplication::fail("No such program: " + args.getValueForOption("--program"));
+
+        processor.setCurrentProgram(program);
+    }
+
+    for (int i = 0; i < args.size() - 1; ++i)
+    {
+        if (args[i] == "-p" || args[i] == "--param")
+        {
+            if (!setParam(processor, args[i + 1].text))
+                ConsoleApplication::fail("Unknown parameter or missing value: " + args[i + 1].text);
+        }
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(inputFile));
+    if (reader == nullptr)
+        ConsoleApplication::fail("Could not read " + inputFile.getFullPathName());
+
+    auto numChannels = (int)reader->numChannels;
+    auto sampleRate = reader->sampleRate;
+    auto inputLength = (int)reader->lengthInSamples;
+    auto totalLength = inputLength + (int)(tailSeconds * sampleRate);
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+
+    if (!processor.setBusesLayout(layout))
+        ConsoleApplication::fail("Unsupported channel count: " + juce::String(numChannels));
+
+    juce::AudioBuffer<float> audio(numChannels, totalLength);
+    audio.clear();
+    reader->read(&audio, 0, inputLength, 0, true, true);
+
+    FixedTempoPlayHead playHead;
+    playHead.bpm = bpm;
+    playHead.sampleRate = sampleRate;
+
+    processor.setPlayHead(&playHead);
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.setNonRealtime(true);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    juce::MidiBuffer midi;
+    RealtimeCheck::resetViolations();
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (int start = 0; start < totalLength; start += blockSize)
+    {
+        auto numSamples = juce::jmin(blockSize, totalLength - start);
+        juce::AudioBuffer<float> block(audio.getArrayOfWritePointers(), numChannels, start, numSamples);
+
+        playHead.samplePosition = start;
+        processor.processBlock(block, midi);
+    }
+
+    auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    processor.releaseResources();
+    processor.setPlayHead(nullptr);
+
+    if (outputFile != juce::File())
+    {
+        outputFile.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream(outputFile.createOutputStream().release());
+        if (stream == nullptr)
+            ConsoleApplication::fail("Could not open " + outputFile.getFullPathName());
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, (unsigned int)numChannels, 24, {}, 0));
+        if (writer == nullptr)
+            ConsoleApplication::fail("Could not create a WAV writer for " + outputFile.getFullPathName());
+
+        stream.release(); // the writer owns the stream now
+        writer->writeFromAudioSampleBuffer(audio, 0, totalLength);
+    }
+
+    auto samplesPerSecond = seconds > 0.0 ? (double)totalLength / seconds : 0.0;
+
+    std::cout << "Rendered " << totalLength << " samples x " << numChannels << " channels"
+              << " at " << sampleRate << " Hz, block " << blockSize << ", " << bpm << " bpm, "
+              << (processor.isParallelProcessingEnabled() && blockSize >= BandSplitDelayAudioProcessor::parallelBlockThreshold
+                      ? "parallel" : "serial") << std::endl;
+    std::cout << "processBlock time: " << seconds << " s" << std::endl;
+
+    if (processor.getLatencySamples() > 0)
+        std::cout << "Latency: " << processor.getLatencySamples() << " samples, not compensated in the output" << std::endl;
+    std::cout << "Throughput: " << (juce::int64)samplesPerSecond << " samples/sec, realtime factor "
+              << samplesPerSecond / sampleRate << "x" << std::endl;
+    std::cout << "Memory per instance: " << processor.getMemoryFootprint() / 1024 << " KiB ("
+              << DelayLine::getFormatName(processor.getDelayStorageFormat()) << " delay storage)" << std::endl;
+
+    if (RealtimeCheck::isEnabled())
+    {
+        std::cout << "Realtime violations inside processBlock: " << RealtimeCheck::getNumViolations() << std::endl;
+
+        if (RealtimeCheck::getNumViolations() > 0)
+            ConsoleApplication::fail("processBlock is not realtime safe, first violation: "
+                                     + juce::String(RealtimeCheck::getFirstViolation()));
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args(argc, argv);
+
+    return juce::ConsoleApplication::invokeCatchingFailures([&] { return render(args); });
+}